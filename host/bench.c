@@ -0,0 +1,176 @@
+// Host (Linux) benchmark, caller cost via vSyslogBenchmark() & end-to-end delivery to a loopback UDP collector
+
+#define _GNU_SOURCE
+
+#include "hal_platform.h"
+#include "hal_timer.h"
+#include "errors_events.h"
+#include "stdioX.h"
+#include "options.h"
+#include "syslog.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// ####################################### Macros & constants ######################################
+
+#define benchPRODUCERS				4
+#define benchCOUNT					10000
+#define benchMS_IDLE				2000				// collector idle this long ends the end-to-end run
+#define benchREPORT_SIZE			8192
+#define benchMARK					"E2E #"				// identifies end-to-end phase messages
+
+// ###################################### Private variables ########################################
+
+typedef struct {
+	TaskHandle_t hOwner;
+	u32_t Base, Count;
+} bench_e2e_t;
+
+static int Collector = -1;								// loopback UDP socket
+static u32_t Received = 0, Datagrams = 0;
+static int OutFD = STDOUT_FILENO;						// results, stdout itself discards console output
+
+// ####################################### Private functions #######################################
+
+/**
+ * @brief	count end-to-end messages received, datagrams may hold a batch of LF separated messages
+ */
+static void * pvBenchCollector(void * pvPara) {
+	char caBuf[2048];
+	for (;;) {
+		ssize_t xLen = recv(Collector, caBuf, sizeof(caBuf), 0);
+		if (xLen <= 0)
+			continue;
+		u32_t Msgs = 0;
+		for (const char * pc = caBuf; (pc = memmem(pc, caBuf + xLen - pc, benchMARK, sizeof(benchMARK) - 1)) != NULL; ++pc)
+			++Msgs;										// late boot/benchmark phase messages not counted
+		__atomic_fetch_add(&Received, Msgs, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&Datagrams, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+/**
+ * @brief	bind the collector to an ephemeral loopback port & point options host [0] at it
+ */
+static int xBenchCollectorStart(void) {
+	struct sockaddr_in sAddr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+	socklen_t Size = sizeof(sAddr);
+	int RcvBuf = 8 << 20;
+	if ((Collector = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ||
+		setsockopt(Collector, SOL_SOCKET, SO_RCVBUF, &RcvBuf, sizeof(RcvBuf)) != 0 ||
+		bind(Collector, (struct sockaddr *) &sAddr, sizeof(sAddr)) != 0 ||
+		getsockname(Collector, (struct sockaddr *) &sAddr, &Size) != 0)
+		return erFAILURE;
+	HostInfo[0] = (hostinfo_t) { .pName = "127.0.0.1", .Port = ntohs(sAddr.sin_port) };
+	vOptionSet(ioHostSLOG, 0);
+	pthread_t tCollector;
+	if (pthread_create(&tCollector, NULL, pvBenchCollector, NULL) != 0)
+		return erFAILURE;
+	pthread_detach(tCollector);
+	return erSUCCESS;
+}
+
+static void vBenchE2ETask(void * pvPara) {
+	bench_e2e_t * psB = pvPara;
+	for (u32_t i = 0; i < psB->Count; ++i)
+		vSyslog(SL_SEV_NOTICE, "slBenchE", benchMARK "%lu value=%d", psB->Base + i, i);
+	xTaskNotifyGive(psB->hOwner);
+	vTaskDelete(NULL);
+}
+
+/**
+ * @brief	messages/s from first call to last message received by the collector, producers blocked when ring full
+ */
+static void vBenchE2E(report_t * psR, int Producers, int Count) {
+	bench_e2e_t sB[slBENCH_TASKS];
+	sl_stats_t sS0, sS1;
+	vSyslogGetStats(&sS0);
+	u32_t Rx0 = __atomic_load_n(&Received, __ATOMIC_RELAXED), Dg0 = __atomic_load_n(&Datagrams, __ATOMIC_RELAXED);
+	u64_t tStart = halTIMER_ReadRunTime();
+	int Started = 0;
+	for (int i = 0; i < Producers; ++i) {
+		sB[i] = (bench_e2e_t) { .hOwner = xTaskGetCurrentTaskHandle(), .Base = i * Count, .Count = Count };
+		if (xTaskCreatePinnedToCore(vBenchE2ETask, "slBench", slTASK_STACK, &sB[i], slTASK_PRIO, NULL,
+				i % portNUM_PROCESSORS) == pdPASS)
+			++Started;
+	}
+	for (int i = 0; i < Started; ++i)
+		ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+	u64_t tCall = halTIMER_ReadRunTime() - tStart, tLast = tCall;
+	u32_t Total = Started * Count, Rx = 0, RxLast = 0;
+	for (u64_t tIdle = halTIMER_ReadRunTime(); (Rx = __atomic_load_n(&Received, __ATOMIC_RELAXED) - Rx0) < Total; vTaskDelay(1)) {
+		u64_t Now = halTIMER_ReadRunTime();
+		if (Rx != RxLast) {								// still arriving
+			RxLast = Rx;
+			tIdle = Now;
+			tLast = Now - tStart;
+		} else if ((Now - tIdle) >= (benchMS_IDLE * 1000ULL)) {
+			break;
+		}
+	}
+	if (Rx >= Total)
+		tLast = halTIMER_ReadRunTime() - tStart;
+	vSyslogGetStats(&sS1);
+	xReport(psR, "E2E\tx%d  sent=%lu  received=%lu (%lu datagrams) in %llums  %llu/s  calls=%llu/s" strNL, Started, Total,
+		Rx, Datagrams - Dg0, tLast / 1000, (Rx * 1000000ULL) / (tLast ? tLast : 1), (Total * 1000000ULL) / (tCall ? tCall : 1));
+	xReport(psR, "\tHost=%lu  SendFails=%lu  RingDrops=%lu  ScratchDrops=%lu  Stored=%lu" strNL,
+		sS1.SinkMsgs[slSINK_HOST] - sS0.SinkMsgs[slSINK_HOST], sS1.SendFails - sS0.SendFails,
+		sS1.RingDrops - sS0.RingDrops, sS1.ScratchDrops - sS0.ScratchDrops,
+		sS1.SinkMsgs[slSINK_FILE] - sS0.SinkMsgs[slSINK_FILE]);
+}
+
+static void vBenchOutput(report_t * psR) {
+	xStdioWrite(OutFD, psR->pcAlloc, psR->pcBuf - psR->pcAlloc);
+	psR->Size += psR->pcBuf - psR->pcAlloc;
+	psR->pcBuf = psR->pcAlloc;
+}
+
+// ######################################## Public functions #######################################
+
+/**
+ * @brief	syslog_bench [producers [count [udp-batch]]], console output discarded, results to stdout
+ */
+int main(int argc, char * argv[]) {
+	int Producers = (argc > 1) ? atoi(argv[1]) : benchPRODUCERS;
+	int Count = (argc > 2) ? atoi(argv[2]) : benchCOUNT;
+	int Batch = (argc > 3) ? atoi(argv[3]) : 0;
+	Producers = (Producers < 1) ? 1 : (Producers > slBENCH_TASKS) ? slBENCH_TASKS : Producers;
+	Count = (Count < 1) ? 1 : (Count > 0xFFFF) ? 0xFFFF : Count;
+	if (xBenchCollectorStart() < erSUCCESS) {
+		perror("collector");
+		return 1;
+	}
+	int Null = open("/dev/null", O_WRONLY);				// console sink stays active, output discarded
+	if ((OutFD = dup(STDOUT_FILENO)) < 0 || Null < 0 || dup2(Null, STDOUT_FILENO) < 0) {
+		perror("stdout");
+		return 1;
+	}
+	close(Null);
+
+	char * pcBuf = malloc(benchREPORT_SIZE);
+	report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,benchREPORT_SIZE) };
+	xReport(&sRpt, "syslog host benchmark: %d producers x %d messages, collector 127.0.0.1:%d, UDP batch %d" strNL,
+		Producers, Count, HostInfo[0].Port, Batch);
+	vBenchOutput(&sRpt);
+	vSyslogInit();
+	vSyslogSetUdpBatch(Batch);
+	vSyslogBenchmark(&sRpt, Producers, Count);
+	vBenchOutput(&sRpt);
+	vSyslogSetRateLimit(0, 0);							// measure delivery, not the limiter
+	vSyslogSetOverflow(slOVF_BLOCK);					// producers paced by the sinks, sustained rate
+	vBenchE2E(&sRpt, Producers, Count);
+	vBenchOutput(&sRpt);
+	if (getenv("SYSLOG_BENCH_REPORT")) {
+		vSyslogReport(&sRpt);
+		vBenchOutput(&sRpt);
+	}
+	free(pcBuf);
+	return 0;
+}
@@ -0,0 +1,56 @@
+// Host (Linux) port, FreeRTOS tasks, notifications & mutexes on POSIX threads, 1mS tick
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_mux_t * SemaphoreHandle_t;
+typedef struct host_task_t * TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE								0
+#define pdTRUE								1
+#define pdFAIL								0
+#define pdPASS								1
+#define portMAX_DELAY						0xFFFFFFFFUL
+#define portTICK_PERIOD_MS					1
+#define pdMS_TO_TICKS(x)					((TickType_t) (x))
+#define portNUM_PROCESSORS					2
+#define portYIELD_FROM_ISR(x)				(void) (x)
+#define tskNO_AFFINITY						0x7FFFFFFF
+#define tskIDLE_PRIORITY					0
+#define taskSCHEDULER_NOT_STARTED			1
+#define taskSCHEDULER_RUNNING				2
+
+/**
+ * @brief	take mutex, created on first use, waiting up to mS (portMAX_DELAY forever)
+ * @return	pdTRUE if taken else pdFALSE
+ */
+BaseType_t xRtosSemaphoreTake(SemaphoreHandle_t * pSH, TickType_t mS);
+BaseType_t xRtosSemaphoreGive(SemaphoreHandle_t * pSH);
+
+/**
+ * @brief	create a task as a detached thread, priority & core ignored, handle set before task runs
+ */
+BaseType_t xTaskCreatePinnedToCore(void (*pvFunc)(void *), const char * pcName, uint32_t Stack, void * pvPara,
+	UBaseType_t Prio, TaskHandle_t * pHandle, BaseType_t Core);
+void vTaskDelete(TaskHandle_t hTask);					// NULL only, calling task exits
+void vTaskDelay(TickType_t Ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);			// threads not created as tasks get one on first use
+const char * pcTaskGetName(TaskHandle_t hTask);
+BaseType_t xTaskGetSchedulerState(void);
+uint32_t ulTaskNotifyTake(BaseType_t bClear, TickType_t Ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t hTask);
+void vTaskNotifyGiveFromISR(TaskHandle_t hTask, BaseType_t * pbWoken);
+BaseType_t xPortInIsrContext(void);						// never, no ISRs on host
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+// Host (Linux) port, error codes & device/status events
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define erSUCCESS							0
+#define erFAILURE							-1
+#define erINV_PARA							-2
+#define erINV_STATE							-3
+#define ESP_OK								0					// esp_err_t success, from esp_err.h
+
+const char * pcStrError(int iRV);
+
+#ifdef __cplusplus
+}
+#endif
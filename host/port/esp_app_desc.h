@@ -0,0 +1,25 @@
+// Host (Linux) port, application description
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	uint32_t magic_word;
+	char version[32];
+	char project_name[32];
+	uint8_t app_elf_sha256[32];
+} esp_app_desc_t;
+
+/**
+ * @brief	description of the running image, ELF SHA-256 unique per process (no-init RAM never retained)
+ */
+const esp_app_desc_t * esp_app_get_description(void);
+
+#ifdef __cplusplus
+}
+#endif
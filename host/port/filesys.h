@@ -0,0 +1,30 @@
+// Host (Linux) port, LittleFS stand-in, absolute paths mapped into a temp directory
+
+#pragma once
+
+#include "FreeRTOS_Support.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern SemaphoreHandle_t shLFSmux;
+
+/**
+ * @brief	map a LittleFS path into the store directory, $SYSLOG_HOST_DIR else a new /tmp/syslog-XXXXXX
+ * @return	pointer to mapped path, valid until the next call by the same thread
+ */
+const char * pcHostPath(const char * pcName);
+ssize_t xFileSysGetFileSize(const char * pcName);
+
+#define fopen(n, m)							fopen(pcHostPath(n), m)
+#define unlink(n)							unlink(pcHostPath(n))
+#define truncate(n, s)						truncate(pcHostPath(n), s)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+// Host (Linux) port, network & device status, loopback always up & store always mounted
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define flagLX_STA							(1UL << 0)			// L2/L3 station connected
+#define devMASK_LFS							(1UL << 0)			// file system mounted
+
+int halEventCheckStatus(uint32_t Mask);
+int halEventCheckDevice(uint32_t Mask);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+// Host (Linux) port, platform attributes, CPU & identity
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "report.h"
+#include "FreeRTOS_Support.h"
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define __NOINIT_ATTR
+#define DRAM_STR(x)							(x)
+
+#define lenMAC_ADDRESS						6
+
+typedef struct {
+	u64_t usecs;										// UTC, updated every mS by the port
+} tsz_t;
+
+extern tsz_t sTSZ;
+extern char idSTA[];									// host name, from gethostname()
+
+int esp_cpu_get_core_id(void);							// CPU the thread runs on, modulo portNUM_PROCESSORS
+uint32_t esp_cpu_get_cycle_count(void);					// nS, see CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+
+#ifdef __cplusplus
+}
+#endif
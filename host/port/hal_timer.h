@@ -0,0 +1,18 @@
+// Host (Linux) port, monotonic run time
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief	uS since the process started, CLOCK_MONOTONIC
+ */
+uint64_t halTIMER_ReadRunTime(void);
+
+#ifdef __cplusplus
+}
+#endif
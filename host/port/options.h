@@ -0,0 +1,25 @@
+// Host (Linux) port, stands in for the options (NVS) component, values kept in RAM
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum { ioHostSLOG, ioSLOGhi, ioSLhost, ioNUM };
+
+typedef struct {
+	const char * pName;
+	uint16_t Port;
+} hostinfo_t;
+
+extern hostinfo_t HostInfo[];							// ioHostSLOG indexes, [0] defaults to 127.0.0.1:514
+
+int xOptionGet(int Idx);
+void vOptionSet(int Idx, int Value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,539 @@
+// Host (Linux) port, POSIX stand-ins for FreeRTOS, printfx, socketsX, LittleFS, options & platform
+
+#define _GNU_SOURCE
+
+#include "hal_platform.h"
+#include "hal_network.h"
+#include "hal_timer.h"
+#include "esp_app_desc.h"
+#include "errors_events.h"
+#include "options.h"
+#include "socketsX.h"
+#include "stdioX.h"
+#include "filesys.h"
+
+#undef fopen											// port itself uses the real calls
+#undef unlink
+#undef truncate
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/stat.h>
+
+// ###################################### Global variables #########################################
+
+tsz_t sTSZ;
+char idSTA[32];
+SemaphoreHandle_t shLFSmux = NULL;
+
+hostinfo_t HostInfo[4] = { { "127.0.0.1", IP_PORT_SYSLOG_UDP } };
+
+// ###################################### Private variables ########################################
+
+struct host_mux_t {
+	pthread_mutex_t mux;
+};
+
+struct host_task_t {
+	pthread_mutex_t mux;
+	pthread_cond_t cond;
+	u32_t notify;										// pending notifications
+	void (*pvFunc)(void *);
+	void * pvPara;
+	char name[16];
+};
+
+static pthread_mutex_t muxCreate = PTHREAD_MUTEX_INITIALIZER;
+static __thread struct host_task_t * psCurrent = NULL;
+static struct timespec tsStart;
+static esp_app_desc_t sAppDesc = { .magic_word = 0xABCD5432, .version = "host", .project_name = "syslog" };
+static int Options[ioNUM] = { 0, SL_LEV_CONSOLE, SL_LEV_HOST };
+static char caStoreDir[PATH_MAX];
+static pthread_once_t onceStore = PTHREAD_ONCE_INIT;
+
+// ####################################### Time & platform #########################################
+
+static u64_t xHostNanos(clockid_t Clock) {
+	struct timespec ts;
+	clock_gettime(Clock, &ts);
+	return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+uint64_t halTIMER_ReadRunTime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((ts.tv_sec - tsStart.tv_sec) * 1000000LL) + ((ts.tv_nsec - tsStart.tv_nsec) / 1000);
+}
+
+uint32_t esp_cpu_get_cycle_count(void) { return (u32_t) xHostNanos(CLOCK_MONOTONIC); }
+
+int esp_cpu_get_core_id(void) {
+	int Core = sched_getcpu();
+	return (Core < 0) ? 0 : Core % portNUM_PROCESSORS;
+}
+
+int halEventCheckStatus(uint32_t Mask) { return 1; }
+
+int halEventCheckDevice(uint32_t Mask) { return 1; }
+
+const esp_app_desc_t * esp_app_get_description(void) { return &sAppDesc; }
+
+const char * pcStrError(int iRV) {
+	return (iRV == erSUCCESS) ? "erSUCCESS" : (iRV == erFAILURE) ? "erFAILURE" :
+		   (iRV == erINV_PARA) ? "erINV_PARA" : (iRV == erINV_STATE) ? "erINV_STATE" : strerror(-iRV);
+}
+
+/**
+ * @brief	keep sTSZ (UTC) current, as the target's timer does
+ */
+static void * pvHostClock(void * pvPara) {
+	for (;;) {
+		__atomic_store_n(&sTSZ.usecs, xHostNanos(CLOCK_REALTIME) / 1000ULL, __ATOMIC_RELAXED);
+		struct timespec ts = { .tv_nsec = 1000000 };
+		nanosleep(&ts, NULL);
+	}
+	return NULL;
+}
+
+__attribute__((constructor)) static void vHostInit(void) {
+	clock_gettime(CLOCK_MONOTONIC, &tsStart);
+	sTSZ.usecs = xHostNanos(CLOCK_REALTIME) / 1000ULL;
+	if (gethostname(idSTA, sizeof(idSTA) - 1) != 0)
+		idSTA[0] = CHR_NUL;
+	u64_t Seed = xHostNanos(CLOCK_REALTIME) ^ ((u64_t) getpid() << 32);
+	for (int i = 0; i < sizeof(sAppDesc.app_elf_sha256); ++i) {	// unique per process
+		Seed = (Seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+		sAppDesc.app_elf_sha256[i] = Seed >> 56;
+	}
+	pthread_t tClock;
+	if (pthread_create(&tClock, NULL, pvHostClock, NULL) == 0)
+		pthread_detach(tClock);
+}
+
+// ########################################### Options #############################################
+
+int xOptionGet(int Idx) { return (Idx >= 0 && Idx < ioNUM) ? Options[Idx] : 0; }
+
+void vOptionSet(int Idx, int Value) {
+	if (Idx >= 0 && Idx < ioNUM)
+		Options[Idx] = Value;
+}
+
+// ###################################### FreeRTOS stand-in ########################################
+
+BaseType_t xRtosSemaphoreTake(SemaphoreHandle_t * pSH, TickType_t mS) {
+	struct host_mux_t * psM = __atomic_load_n(pSH, __ATOMIC_ACQUIRE);
+	if (psM == NULL) {									// created on first use
+		pthread_mutex_lock(&muxCreate);
+		if ((psM = *pSH) == NULL && (psM = malloc(sizeof(struct host_mux_t))) != NULL) {
+			pthread_mutex_init(&psM->mux, NULL);
+			__atomic_store_n(pSH, psM, __ATOMIC_RELEASE);
+		}
+		pthread_mutex_unlock(&muxCreate);
+		if (psM == NULL)
+			return pdFALSE;
+	}
+	if (mS == portMAX_DELAY)
+		return (pthread_mutex_lock(&psM->mux) == 0) ? pdTRUE : pdFALSE;
+	u64_t Until = xHostNanos(CLOCK_REALTIME) + (mS * 1000000ULL);
+	struct timespec ts = { .tv_sec = Until / 1000000000ULL, .tv_nsec = Until % 1000000000ULL };
+	return (pthread_mutex_timedlock(&psM->mux, &ts) == 0) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xRtosSemaphoreGive(SemaphoreHandle_t * pSH) {
+	struct host_mux_t * psM = __atomic_load_n(pSH, __ATOMIC_ACQUIRE);
+	return (psM && pthread_mutex_unlock(&psM->mux) == 0) ? pdTRUE : pdFALSE;
+}
+
+static struct host_task_t * psHostTaskNew(const char * pcName) {
+	struct host_task_t * psT = calloc(1, sizeof(struct host_task_t));
+	if (psT == NULL)
+		return NULL;
+	pthread_condattr_t sAttr;
+	pthread_condattr_init(&sAttr);
+	pthread_condattr_setclock(&sAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&psT->cond, &sAttr);
+	pthread_condattr_destroy(&sAttr);
+	pthread_mutex_init(&psT->mux, NULL);
+	strncpy(psT->name, pcName, sizeof(psT->name) - 1);
+	return psT;
+}
+
+static void * pvHostTaskStart(void * pvPara) {
+	psCurrent = pvPara;
+	psCurrent->pvFunc(psCurrent->pvPara);
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*pvFunc)(void *), const char * pcName, uint32_t Stack, void * pvPara,
+	UBaseType_t Prio, TaskHandle_t * pHandle, BaseType_t Core) {
+	struct host_task_t * psT = psHostTaskNew(pcName);
+	if (psT == NULL)
+		return pdFAIL;
+	psT->pvFunc = pvFunc;
+	psT->pvPara = pvPara;
+	if (pHandle)
+		*pHandle = psT;
+	pthread_t tTask;
+	if (pthread_create(&tTask, NULL, pvHostTaskStart, psT) != 0) {
+		if (pHandle)
+			*pHandle = NULL;
+		free(psT);
+		return pdFAIL;
+	}
+	pthread_detach(tTask);
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t hTask) {
+	if (hTask != NULL && hTask != psCurrent)
+		return;											// deleting another task not supported
+	pthread_exit(NULL);									// handle kept, may still be referenced
+}
+
+void vTaskDelay(TickType_t Ticks) {
+	if (Ticks == 0) {
+		sched_yield();
+		return;
+	}
+	struct timespec ts = { .tv_sec = Ticks / 1000, .tv_nsec = (Ticks % 1000) * 1000000L };
+	nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void) { return halTIMER_ReadRunTime() / 1000ULL; }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	if (psCurrent == NULL)								// thread not created as a task
+		psCurrent = psHostTaskNew("main");
+	return psCurrent;
+}
+
+const char * pcTaskGetName(TaskHandle_t hTask) {
+	hTask = hTask ? hTask : xTaskGetCurrentTaskHandle();
+	return hTask ? hTask->name : "?";
+}
+
+BaseType_t xTaskGetSchedulerState(void) { return taskSCHEDULER_RUNNING; }
+
+BaseType_t xPortInIsrContext(void) { return 0; }
+
+uint32_t ulTaskNotifyTake(BaseType_t bClear, TickType_t Ticks) {
+	struct host_task_t * psT = xTaskGetCurrentTaskHandle();
+	pthread_mutex_lock(&psT->mux);
+	if (psT->notify == 0 && Ticks) {
+		u64_t Until = xHostNanos(CLOCK_MONOTONIC) + (Ticks * 1000000ULL);
+		struct timespec ts = { .tv_sec = Until / 1000000000ULL, .tv_nsec = Until % 1000000000ULL };
+		while (psT->notify == 0) {
+			if (Ticks == portMAX_DELAY)
+				pthread_cond_wait(&psT->cond, &psT->mux);
+			else if (pthread_cond_timedwait(&psT->cond, &psT->mux, &ts) == ETIMEDOUT)
+				break;
+		}
+	}
+	u32_t Value = psT->notify;
+	psT->notify = (bClear || Value == 0) ? 0 : Value - 1;
+	pthread_mutex_unlock(&psT->mux);
+	return Value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t hTask) {
+	pthread_mutex_lock(&hTask->mux);
+	++hTask->notify;
+	pthread_cond_signal(&hTask->cond);
+	pthread_mutex_unlock(&hTask->mux);
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t hTask, BaseType_t * pbWoken) {
+	xTaskNotifyGive(hTask);
+	if (pbWoken)
+		*pbWoken = pdFALSE;
+}
+
+// ####################################### printfx stand-in ########################################
+
+typedef struct {
+	report_t * psR;
+	int xLen;
+} host_out_t;
+
+static void vHostPut(host_out_t * psO, const char * pc, int xLen) {
+	report_t * psR = psO->psR;
+	if (xLen <= 0)
+		return;
+	if (psR && psR->pcBuf) {
+		size_t Room = psR->Size & ~repSGR_FLAG;
+		if (Room <= 1)
+			return;
+		xLen = ((size_t) xLen < Room) ? xLen : (int) Room - 1;	// always terminated
+		memcpy(psR->pcBuf, pc, xLen);
+		psR->pcBuf += xLen;
+		*psR->pcBuf = CHR_NUL;
+		psR->Size -= xLen;
+	} else {
+		fwrite(pc, 1, xLen, stdout);
+	}
+	psO->xLen += xLen;
+}
+
+/**
+ * @brief	%R, uS UTC as ISO 8601 date & time, or time only with '!', Prec fractional digits (max 6)
+ */
+static int xHostTime(char * pcBuf, size_t Size, u64_t Usecs, bool bTime, int Prec) {
+	time_t Secs = Usecs / 1000000ULL;
+	struct tm sTM;
+	gmtime_r(&Secs, &sTM);
+	int xLen = strftime(pcBuf, Size, bTime ? "%H:%M:%S" : "%Y-%m-%dT%H:%M:%S", &sTM);
+	if (Prec > 0) {
+		Prec = (Prec > 6) ? 6 : Prec;
+		u32_t Frac = Usecs % 1000000ULL;
+		for (int i = Prec; i < 6; ++i)
+			Frac /= 10;
+		xLen += snprintf(pcBuf + xLen, Size - xLen, ".%0*u", Prec, Frac);
+	}
+	if (bTime == 0)
+		xLen += snprintf(pcBuf + xLen, Size - xLen, "Z");
+	return xLen;
+}
+
+int xvReport(report_t * psR, const char * pcFmt, va_list vaList) {
+	host_out_t sO = { .psR = psR };
+	va_list vaArgs;
+	va_copy(vaArgs, vaList);
+	char caSpec[32], caTmp[512];
+	const char * pc = pcFmt;
+	while (*pc) {
+		if (*pc != '%') {
+			const char * pcEnd = strchrnul(pc, '%');
+			vHostPut(&sO, pc, pcEnd - pc);
+			pc = pcEnd;
+			continue;
+		}
+		if (pc[1] == '%') {
+			vHostPut(&sO, "%", 1);
+			pc += 2;
+			continue;
+		}
+		// parse flags, width, precision & length, '!' and 'l' consumed here
+		const char * pcStart = pc++;
+		int n = 0, Prec = -1, Long = 0, Size = 0;		// Size 'z' or 'j'
+		bool bBang = 0;
+		caSpec[n++] = '%';
+		for (; *pc && strchr("-+ #0!", *pc); ++pc) {
+			if (*pc == '!')
+				bBang = 1;
+			else if (n < 8)
+				caSpec[n++] = *pc;
+		}
+		if (*pc == '*') {
+			n += snprintf(&caSpec[n], 8, "%d", va_arg(vaArgs, int));
+			++pc;
+		}
+		while (isdigit((int) *pc) && n < 16)
+			caSpec[n++] = *pc++;
+		if (*pc == '.') {
+			caSpec[n++] = *pc++;
+			if (*pc == '*') {
+				Prec = va_arg(vaArgs, int);
+				n += snprintf(&caSpec[n], 8, "%d", Prec);
+				++pc;
+			} else {
+				Prec = atoi(pc);
+				while (isdigit((int) *pc) && n < 24)
+					caSpec[n++] = *pc++;
+			}
+		}
+		for (; *pc && strchr("hlzjtL", *pc); ++pc) {
+			if (*pc == 'l')
+				++Long;
+			else if (*pc == 'z' || *pc == 'j' || *pc == 't')
+				Size = *pc;
+			else if (*pc == 'h')
+				caSpec[n++] = *pc;
+		}
+		char Conv = *pc ? *pc++ : CHR_NUL;
+		int xLen = 0;
+		switch (Conv) {
+		case 'C': {										// SGR colour, only if enabled for the report
+			u32_t Col = va_arg(vaArgs, unsigned int);
+			if (psR && (psR->Size & repSGR_FLAG))
+				xLen = (Col & 0xFF) ? snprintf(caTmp, sizeof(caTmp), "\033[%um", Col & 0xFF) :
+									  snprintf(caTmp, sizeof(caTmp), "\033[0m");
+			break;
+		}
+		case 'R':
+			xLen = xHostTime(caTmp, sizeof(caTmp), va_arg(vaArgs, u64_t), bBang, Prec);
+			break;
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c': {
+			bool bSigned = (Conv == 'd' || Conv == 'i');
+			if (Long >= 2) {							// 64 bit
+				strcpy(&caSpec[n], "ll");
+				caSpec[n + 2] = Conv;
+				caSpec[n + 3] = CHR_NUL;
+				xLen = bSigned ? snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, long long)) :
+								 snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, unsigned long long));
+			} else if (Size) {							// size_t, intmax_t or ptrdiff_t
+				caSpec[n] = 'j';
+				caSpec[n + 1] = Conv;
+				caSpec[n + 2] = CHR_NUL;
+				xLen = bSigned ? snprintf(caTmp, sizeof(caTmp), caSpec, (intmax_t) va_arg(vaArgs, ssize_t)) :
+								 snprintf(caTmp, sizeof(caTmp), caSpec, (uintmax_t) va_arg(vaArgs, size_t));
+			} else {									// int, and 'l' which is 32 bit on the target
+				caSpec[n] = Conv;
+				caSpec[n + 1] = CHR_NUL;
+				xLen = bSigned ? snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, int)) :
+								 snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, unsigned int));
+			}
+			break;
+		}
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			caSpec[n] = Conv;
+			caSpec[n + 1] = CHR_NUL;
+			xLen = snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, double));
+			break;
+		case 's': {
+			const char * pcStr = va_arg(vaArgs, const char *);
+			pcStr = pcStr ? pcStr : "(null)";
+			if (n == 1) {								// no flags, width or precision
+				vHostPut(&sO, pcStr, strlen(pcStr));
+				continue;
+			}
+			caSpec[n] = Conv;
+			caSpec[n + 1] = CHR_NUL;
+			xLen = snprintf(caTmp, sizeof(caTmp), caSpec, pcStr);
+			break;
+		}
+		case 'p':
+			caSpec[n] = Conv;
+			caSpec[n + 1] = CHR_NUL;
+			xLen = snprintf(caTmp, sizeof(caTmp), caSpec, va_arg(vaArgs, void *));
+			break;
+		case 'n':
+			(void) va_arg(vaArgs, int *);				// never written
+			break;
+		default:										// unknown, output as is
+			vHostPut(&sO, pcStart, pc - pcStart);
+			continue;
+		}
+		vHostPut(&sO, caTmp, (xLen < (int) sizeof(caTmp)) ? xLen : (int) sizeof(caTmp) - 1);
+	}
+	va_end(vaArgs);
+	if (psR == NULL || psR->pcBuf == NULL)
+		fflush(stdout);
+	return sO.xLen;
+}
+
+int xReport(report_t * psR, const char * pcFmt, ...) {
+	va_list vaList;
+	va_start(vaList, pcFmt);
+	int iRV = xvReport(psR, pcFmt, vaList);
+	va_end(vaList);
+	return iRV;
+}
+
+int xStdioWrite(int fd, const void * pvBuf, int Len) {
+	int Done = 0;
+	while (Done < Len) {
+		ssize_t Wr = write(fd, (const char *) pvBuf + Done, Len - Done);
+		if (Wr <= 0)
+			return Done ? Done : erFAILURE;
+		Done += Wr;
+	}
+	return Done;
+}
+
+// ###################################### socketsX stand-in ########################################
+
+int xNetOpen(netx_t * psCtx) {
+	psCtx->sd = -1;
+	if (psCtx->psSec) {									// TLS not available on host
+		psCtx->error = EPROTONOSUPPORT;
+		return erFAILURE;
+	}
+	if (inet_pton(AF_INET, psCtx->pHost, &psCtx->sa_in.sin_addr) != 1) {
+		struct addrinfo sHints = { .ai_family = AF_INET, .ai_socktype = psCtx->c.type }, * psAI = NULL;
+		if (getaddrinfo(psCtx->pHost, NULL, &sHints, &psAI) != 0 || psAI == NULL) {
+			psCtx->error = EHOSTUNREACH;
+			return erFAILURE;
+		}
+		psCtx->sa_in.sin_addr = ((struct sockaddr_in *) psAI->ai_addr)->sin_addr;
+		freeaddrinfo(psAI);
+	}
+	int sd = socket(AF_INET, psCtx->c.type, 0);
+	if (sd < 0) {
+		psCtx->error = errno;
+		return erFAILURE;
+	}
+	int One = 1;
+	if ((psCtx->flags && setsockopt(sd, SOL_SOCKET, psCtx->flags, &One, sizeof(One)) != 0) ||
+		connect(sd, (struct sockaddr *) &psCtx->sa_in, sizeof(psCtx->sa_in)) != 0) {
+		psCtx->error = errno;
+		close(sd);
+		return erFAILURE;
+	}
+	psCtx->sd = sd;
+	psCtx->error = 0;
+	return sd;
+}
+
+int xNetClose(netx_t * psCtx) {
+	if (psCtx->sd >= 0)
+		close(psCtx->sd);
+	psCtx->sd = -1;
+	return erSUCCESS;
+}
+
+int xNetSend(netx_t * psCtx, u8_t * pBuf, int xLen) {
+	ssize_t Sent = send(psCtx->sd, pBuf, xLen, MSG_NOSIGNAL);
+	if (Sent < 0) {
+		psCtx->error = errno;
+		return erFAILURE;
+	}
+	return Sent;
+}
+
+int xNetSetRecvTO(netx_t * psCtx, u32_t mS) {
+	if (mS == flagXNET_NONBLOCK)						// socket non-blocking, send included
+		return (fcntl(psCtx->sd, F_SETFL, fcntl(psCtx->sd, F_GETFL) | O_NONBLOCK) == 0) ? erSUCCESS : erFAILURE;
+	struct timeval tv = { .tv_sec = mS / 1000, .tv_usec = (mS % 1000) * 1000 };
+	return (setsockopt(psCtx->sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0) ? erSUCCESS : erFAILURE;
+}
+
+int xNetCloseDuplicates(u16_t Port) { return 0; }
+
+int xNetReport(report_t * psR, netx_t * psCtx, const char * pcName, int Code, void * pVoid, int xLen) {
+	char caAddr[INET_ADDRSTRLEN];
+	inet_ntop(AF_INET, &psCtx->sa_in.sin_addr, caAddr, sizeof(caAddr));
+	return xReport(psR, "\t%s sd=%d %s:%d %s error=%d" strNL, pcName, psCtx->sd, caAddr, ntohs(psCtx->sa_in.sin_port),
+		(psCtx->c.type == SOCK_DGRAM) ? "UDP" : "TCP", psCtx->error);
+}
+
+// ###################################### LittleFS stand-in ########################################
+
+static void vHostStoreDir(void) {
+	const char * pcDir = getenv("SYSLOG_HOST_DIR");
+	if (pcDir && *pcDir) {
+		snprintf(caStoreDir, sizeof(caStoreDir), "%s", pcDir);
+		mkdir(caStoreDir, 0700);
+	} else {
+		strcpy(caStoreDir, "/tmp/syslog-XXXXXX");
+		if (mkdtemp(caStoreDir) == NULL)
+			strcpy(caStoreDir, ".");
+	}
+}
+
+const char * pcHostPath(const char * pcName) {
+	static __thread char caPath[PATH_MAX];
+	pthread_once(&onceStore, vHostStoreDir);
+	snprintf(caPath, sizeof(caPath), "%s%s%s", caStoreDir, (*pcName == '/') ? "" : "/", pcName);
+	return caPath;
+}
+
+ssize_t xFileSysGetFileSize(const char * pcName) {
+	struct stat sStat;
+	return (stat(pcHostPath(pcName), &sStat) == 0) ? sStat.st_size : erFAILURE;
+}
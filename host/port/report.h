@@ -0,0 +1,61 @@
+// Host (Linux) port, stands in for printfx report_t output, buffer or stdout
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef uint64_t u64_t;
+typedef int8_t i8_t;
+typedef int16_t i16_t;
+typedef int32_t i32_t;
+typedef int64_t i64_t;
+
+#define CHR_NUL								'\0'
+#define CHR_LF								'\n'
+#define CHR_CR								'\r'
+#define CHR_SPACE							' '
+#define strNL								"\r\n"
+
+// SGR colour & attribute for %C, foreground in bits [7:0], background in bits [15:8]
+#define xpfCOL(fg,bg)						((fg) | ((bg) << 8))
+#define attrRESET							0
+#define colourFG_RED						31
+#define colourFG_GREEN						32
+#define colourFG_YELLOW						33
+#define colourFG_MAGENTA					35
+#define colourFG_CYAN						36
+
+#define sBUFFER								1					// output to pcBuf, else stdout
+#define sgrNONE								0					// %C emits nothing
+#define sgrANSI								1					// %C emits ANSI SGR sequence
+#define repSGR_FLAG							((size_t) 1 << 31)
+#define repSIZE_SET(io,sgr,x,y,size)		((size_t) (size) | ((sgr) ? repSGR_FLAG : 0))
+
+typedef struct report_t {
+	char * pcAlloc;										// start of buffer
+	char * pcBuf;										// next character, advanced as written
+	size_t Size;										// space remaining, repSGR_FLAG if %C enabled
+} report_t;
+
+/**
+ * @brief	printf to psR buffer (truncated, always terminated) or stdout if psR or its buffer NULL
+ * @return	number of characters written
+ * @note	printfx extensions: %C SGR colour, %R uS timestamp (.3 mS, ! time only), %l 32 bit (ILP32 target)
+ */
+int xvReport(report_t * psR, const char * pcFmt, va_list vaList);
+int xReport(report_t * psR, const char * pcFmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+// Host (Linux) port, stands in for the ESP-IDF generated sdkconfig.h & application configuration
+
+#pragma once
+
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ		1000				// esp_cpu_get_cycle_count() counts nS
+
+#define appLITTLEFS							1					// offline store in a temp directory, see filesys.h
+#define appOPTIONS							1					// host & levels from options.h stand-in
+
+#define SL_LEV_MAX							7					// compile time maximum level, SL_LOG() gate
+#define SL_LEV_CONSOLE						7
+#define SL_LEV_HOST							7
@@ -0,0 +1,47 @@
+// Host (Linux) port, socketsX UDP/TCP over BSD sockets, no TLS
+
+#pragma once
+
+#include "report.h"
+
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IP_PORT_SYSLOG_UDP					514
+#define flagXNET_NONBLOCK					1
+
+typedef struct {
+	const char * pcCA;
+	int szCA;
+} sec_t;
+
+typedef struct {
+	const char * pHost;									// numeric or name, resolved by xNetOpen()
+	struct sockaddr_in sa_in;
+	sec_t * psSec;										// TLS not supported, xNetOpen() fails
+	size_t maxTx;
+	int sd;
+	int flags;											// setsockopt() SOL_SOCKET option to enable
+	int error;
+	struct {
+		int type;										// SOCK_DGRAM or SOCK_STREAM
+		int NoSyslog;
+	} c;
+} netx_t;
+
+int xNetOpen(netx_t * psCtx);
+int xNetClose(netx_t * psCtx);
+int xNetSend(netx_t * psCtx, u8_t * pBuf, int xLen);
+int xNetSetRecvTO(netx_t * psCtx, u32_t mS);
+int xNetCloseDuplicates(u16_t Port);
+int xNetReport(report_t * psR, netx_t * psCtx, const char * pcName, int Code, void * pVoid, int xLen);
+
+#ifdef __cplusplus
+}
+#endif
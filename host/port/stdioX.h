@@ -0,0 +1,15 @@
+// Host (Linux) port, low level unbuffered console output
+
+#pragma once
+
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int xStdioWrite(int fd, const void * pvBuf, int Len);
+
+#ifdef __cplusplus
+}
+#endif
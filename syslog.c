@@ -5,6 +5,38 @@
  *
  *	#1	Messages with SEVerity <= ioSLOGhi are sent to the console
  *	#2	Messages with SEVerity <= ioSLhost will be logged to the syslog server
+ *	#3	Functions matching a module override (name prefix) use that level for both console & host
+ *
+ *	Levels are cached in the SLlevels snapshot, refreshed by the setters and every task tick, so that
+ *	SL_LOG() can reject filtered messages inline, before any arguments are evaluated.
+ *
+ *	The signature used for repeat detection is hashed from the call site ID (task, FuncID & format pointers
+ *	plus the line# SL_LOG() passes in PRI bits [30:16]) and the raw captured argument words, %s by content,
+ *	so repeats are counted and dropped without any formatting. Only formats that cannot be captured are
+ *	rendered first and the rendered bytes hashed instead.
+ *
+ *	Each message body is rendered at most once, slHEADROOM bytes into a scratch buffer. The console and
+ *	host sinks then render only their own header into the headroom, immediately ahead of the body, and
+ *	write header+body in one go.
+ *
+ *	Messages that cannot be sent to the host are appended, via a RAM buffer, to a ring of slSEG_COUNT
+ *	segment files. Each record holds PRI & UTC as binary fields and the text following the hostname, so
+ *	the PRE header is rendered and the hostname bound only at replay. The RAM buffer is written as a
+ *	single block, compressed by a small LZ77 coder (no dictionary beyond the block). When the ring is full
+ *	the oldest segment is evicted. A persisted cursor (segment sequence, block & record) lets replay resume
+ *	at the exact record where it stopped, even across a restart. Each segment has a sparse index file
+ *	with an entry per block (offset, first record's UTC second & severity bitmap), appended once the block
+ *	is written and rebuilt from the blocks if missing or stale, so xSyslogQuery() only reads & decompresses
+ *	blocks that could match a time range or severity, and finds the start of the last N records from the end.
+ *
+ *	During boot, until the first connection, host messages (incl those logged before the scheduler starts)
+ *	are encoded as records in a RAM staging buffer of slSTAGE_SIZE. Once connected they are sent, with the
+ *	hostname bound then, or if older backlog exists, the buffer fills or slMS_STAGE_HOLD expires, they are
+ *	written to the store in a single write. Staging then ends for the rest of the session.
+ *
+ *	Replay is done in passes of at most slREPLAY_MSGS records, limited by a token bucket refilled at
+ *	slREPLAY_BPS, with locks released between passes. The syslog task alternates between draining live
+ *	messages and a replay pass, so neither live logging nor other file system users are starved.
  *
  *	To minimise the impact on application size the SL_xxxx macros must be used to in/exclude levels of info.
  * 		SL_DBG() to control inclusion and display of DEBUG type information
@@ -13,11 +45,65 @@
  *		SL_WARN() to inform on concerns such as values closely approaching threshold
  *		SL_ERR() for errors that the system can/will recover from automatically
  *		SL_CRIT/ALRT/EMER() reserved for unrecoverable errors that should result in a system restart
+ *
+ *	Repeats are detected against a table of the slDEDUP_SIZE most recent message signatures. The first
+ *	occurrence is delivered, subsequent ones are only counted. Every slMS_DEDUP_WINDOW entries with a
+ *	non-zero count emit a "Repeated Nx in T ms" summary, as does an entry evicted to make space, so no
+ *	repeat count is held back indefinitely or lost. Idle entries are freed after the same window.
+ *
+ *	Each host connection is a state machine, DOWN -> CONNECTING -> UP, with any failure moving it to
+ *	BACKOFF for an exponentially increasing period (slMS_BACKOFF_MIN..MAX). While in BACKOFF, or UP, a
+ *	message costs a single atomic load of the state; only the housekeeping tick returns it to DOWN. The
+ *	resolved host address is cached for slRESOLVE_TTL, or until slRESOLVE_RETRIES consecutive failures.
+ *
+ *	Hosts form a registry of slHOSTS entries, each with its own connection, backoff, batch and level, the
+ *	header & body rendered once for all. Entry 0 (from options) and other slROLE_FAILOVER entries form the
+ *	failover group: messages go to the first connected entry in order, so a dead host is skipped at the
+ *	cost of an atomic load and the preferred host is retried, and failed back to, once its backoff expires.
+ *	Only the group is staged & backed by the offline store. slROLE_COPY entries get every message within
+ *	their own level, dropped & counted while down, and never feed the governor. Once the syslog task runs,
+ *	the slNet task makes all connection attempts (name resolution, TCP/TLS handshake), holding shSLnet and
+ *	not shSLsock, and connected sockets are non-blocking, so a dead host never delays delivery to live ones.
+ *	Before that, or without slASYNC, the caller connects inline and shares the same bounded waits.
+ *
+ *	Host messages, live and replayed, are appended to a batch buffer and written with a single send. The
+ *	transport is UDP (1 message per datagram, or LF separated messages packed up to UdpBatch bytes if
+ *	enabled), or TCP/TLS using RFC6587 octet counting framing. Only the
+ *	syslog task holds stream messages back, flushing when the batch is full, a message of SL_SEV_ERROR or
+ *	higher is added, or the oldest message is slMS_BATCH_FLUSH old. If a send fails, live messages in the
+ *	batch go to the offline store while replayed ones stay there, the cursor only advancing once sent.
+ *
+ *	Messages below slRATE_EXEMPT severity must obtain a token from both a PRI keyed and a FuncID keyed
+ *	bucket, else they are counted and discarded before any rendering. The host governor evaluates send
+ *	failures and latency every slMS_GOV_WINDOW, lowering the effective host level by one step when either
+ *	crosses its limit, and restoring one step at a time after slMS_GOV_RESTORE without trips.
+ *
+ *	Callers never block on another logger: scratch buffers are claimed from a pool with an atomic bitmap
+ *	(message dropped & counted if none free), repeat detection uses a CAS on a per-entry packed word
+ *	(signature[31:8] | count[7:0]) and rate limit buckets use a CAS on a single GCRA arrival time word.
+ *	Non-key fields of dedup entries are informational and updated without ordering guarantees.
+ *	Exceptions: slOVF_BLOCK by definition, and delivery by the caller (no syslog task) which shares the
+ *	socket (shSLsock, bounded by slMS_LOCK_WAIT) and offline store (shSLfile) with other callers.
+ *
+ *	With slASYNC enabled, and once vSyslogInit() has started the syslog task, callers only render the
+ *	message body into a slot claimed from a lock-free MPSC ring. The syslog task drains the ring and does
+ *	all console, host & file IO. If the ring is full the configured overflow policy is applied.
+ *
+ *	With slDEFERRED also enabled the caller does not render at all. The format pointer and raw argument
+ *	words are captured into the slot, with %s arguments copied into the slot (copy-on-capture) so that no
+ *	dangling pointer can survive. Rendering happens in the syslog task, or never if the slot is evicted.
+ *	Formats with conversions that cannot be captured safely (*, %n, unknown) are rendered by the caller.
+ *
+ *	With slTRACE enabled every message up to TraceLevel, even if below console/host levels, is captured
+ *	(format pointer, raw arguments & copied strings) into a ring in no-init RAM. Records not sent to the
+ *	host are rendered to it (or the offline store) when a message of SL_SEV_ERROR or higher is logged.
+ *	Records retained through a soft reset or panic, from the same build, are all rendered after restart.
 */
 
 #include "hal_platform.h"
 #include "hal_network.h"
 #include "hal_timer.h"
+#include "esp_app_desc.h"
 
 #include "stdioX.h"
 #include "syslog.h"
@@ -33,6 +119,8 @@
 #endif
 
 #include <errno.h>
+#include <netdb.h>
+#include <unistd.h>
 
 #ifdef ESP_PLATFORM
 	#include "esp_log.h"
@@ -46,22 +134,235 @@
 #define debugPARAM				(debugFLAG_GLOBAL & debugFLAG & 0x4000)
 #define debugRESULT				(debugFLAG_GLOBAL & debugFLAG & 0x8000)
 
+#define slSTAT_ADD(m, n)		__atomic_fetch_add(&sStats.m, (n), __ATOMIC_RELAXED)
+#define slSTAT_INC(m)			slSTAT_ADD(m, 1)
+
 // ######################################### Structures ############################################
 
 typedef struct {
 	struct __attribute__((packed)) {
-		u16_t count:16;
+		u16_t count:15;
+		u16_t sd:1;										// body starts with SD-ELEMENT(s), replaces NILVALUE
 		u8_t pri:8;
 		u8_t core:4;
-		u8_t spare:4;
+		u8_t hlev:4;									// host level in effect when logged
 	};
 	u32_t crc;
 	u64_t run, utc;
 	const char *task, *func;
 } sl_vars_t;
 
+enum { slCON_DOWN, slCON_CONNECTING, slCON_UP, slCON_BACKOFF };
+
+typedef struct {
+	char name[slMODULE_LEN];
+	u8_t len;
+	u8_t level;
+} sl_module_t;
+
+typedef struct {
+	const void * key;									// PRI or FuncID owning the bucket
+	u32_t tat;											// GCRA theoretical arrival time, uS
+	u32_t drops;										// messages discarded while key owned bucket
+} sl_bucket_t;
+
+typedef struct {
+	u32_t key;											// signature[31:8] | repeats[7:0], 0 if free
+	u64_t first;										// run time of first occurrence in window
+	sl_vars_t sV;										// last occurrence, count only valid in summaries
+} sl_dedup_t;
+
+#define slDEDUP_SIG(k)		((k) & 0xFFFFFF00UL)
+#define slDEDUP_CNT(k)		((k) & 0x000000FFUL)
+
+typedef struct __attribute__((packed)) {
+	u16_t len;											// length of header remainder & body after hostname
+	u8_t pri;
+	u32_t sec;											// UTC seconds & milliseconds, PRE rendered at replay
+	u16_t msec;
+} sl_frec_t;
+
+#define slFREC_UTC(psR)		(((u64_t) (psR)->sec * 1000000ULL) + ((psR)->msec * 1000ULL))
+
+typedef struct __attribute__((packed)) {
+	u16_t raw;											// length of records in block
+	u16_t packed;										// length of compressed data following, 0 if stored raw
+} sl_fblk_t;
+
+typedef struct {
+	u32_t magic;
+	u32_t rdSeq, wrSeq;									// oldest (read) & newest (write) segment sequence#
+	u32_t rdOfs;										// offset of block with next record in segment rdSeq
+	u32_t rdRec;										// offset of next record in decompressed block
+} sl_fcur_t;
+
+#define slCUR_MAGIC			0x534C4332UL				// "SLC2"
+
+typedef struct __attribute__((packed)) {
+	u16_t ofs;											// block offset in segment
+	u8_t sev;											// bitmap of severities in block
+	u8_t count;											// records in block, saturating
+	u32_t sec;											// UTC seconds of first record
+} sl_fidx_t;
+
+#define slIDX_MAX			(slSEG_SIZE / (sizeof(sl_fblk_t) + sizeof(sl_frec_t)) + 1)
+
+#if (slSEG_SIZE > 0xFFFF)
+	#error "slSEG_SIZE too large for 16 bit index block offset"
+#endif
+
+#define slLZ_HASH			256							// match finder table entries
+#define slLZ_MIN			3							// shortest match
+#define slLZ_MAX			(slLZ_MIN + 31)				// longest match, 5 bit length
+#define slLZ_WINDOW			1024						// furthest match, 10 bit offset
+#define slLZ_LITS			128							// longest literal run
+
+typedef struct {
+	u16_t ofs, len;										// message, excluding frame prefix, in batch
+	u8_t host, name;									// hostname offset & length, for offline store
+	u8_t spill;											// move to offline store if batch send fails
+	u8_t replay;										// replayed from offline store
+	u8_t pri;
+	u64_t utc;
+} sl_bmsg_t;
+
+typedef struct {
+	netx_t sCtx;
+	const char * pName;									// host name as configured
+	u8_t state;											// slCON_xxx
+	u8_t retries;										// consecutive failures
+	u8_t role;											// slROLE_xxx
+	u8_t level;											// max severity sent, slLEV_FOLLOW for host level
+	u16_t port;											// 0 = transport default
+	u32_t backoff;										// current backoff period in mS
+	u64_t tNext;										// run time when BACKOFF expires
+	u64_t tResolve;										// run time when cached address expires
+	char caAddr[16];									// cached resolved address, dotted decimal
+	char caName[slHOST_NAME];							// registered name, entry 0 uses options
+	u32_t sent, fails, drops;							// messages sent, failed sends, copies dropped
+	u16_t blen;											// batch, own buffer per host
+	u8_t bcount;
+	u64_t btime;										// run time first message added to batch
+	sl_bmsg_t bmsg[slBATCH_MSGS];
+	char batch[slBATCH_SIZE];
+} sl_host_t;
+
+#define slLEV_FOLLOW		0x0F						// host level (options/module) & governor
+
+#define slHOST_ID()			(idSTA[0] ? (const char *) idSTA : UNKNOWNMACAD)	// placeholder until WIFI, idSTA untouched
+
+#define slFRAME_MAX			8							// octet count prefix "NNNNN " & terminator
+
+#if (slBATCH_SIZE < (slSIZEBUF + slFRAME_MAX))
+	#error "slBATCH_SIZE too small for largest message"
+#endif
+#if (slSTAGE_SIZE > slSEG_SIZE)
+	#error "slSTAGE_SIZE must fit in a single store segment"
+#endif
+#if ((slLANE_HI & (slLANE_HI - 1)) | (slLANE_MID & (slLANE_MID - 1)) | (slRING_SLOTS & (slRING_SLOTS - 1)))
+	#error "slLANE_HI, slLANE_MID & slRING_SLOTS must be powers of 2"
+#endif
+#if (slCON_BUF & (slCON_BUF - 1))
+	#error "slCON_BUF must be a power of 2"
+#endif
+#if (slRING_BODY > slBODYSIZE) || (slRING_BODY < 16)
+	#error "slRING_BODY must be 16..slBODYSIZE"
+#endif
+
+#define slTRUNC_MARK		"..."						// replaces end of body or %s string cut to fit a slot
+#if (slSTORE_BUF > slLZ_WINDOW) || ((slSTORE_BUF + 8) > slSEG_SIZE)
+	#error "slSTORE_BUF must be <= 1024 and fit in a single store segment"
+#endif
+
+#define slFRAG_LEN			32							// cached timestamp, task fragment or hostname
+#define slFRAG_CONSOLE		2							// task fragment kind, after slFMT_PAPERTRAIL/RFC5424
+#define slSGR_LEN			12							// cached console colour sequence
+
+typedef struct {
+	u32_t seq;											// even when stable, odd while being updated
+	const void * key;									// task name, NULL for timestamps
+	u32_t tag;											// second (timestamps), core | kind << 8 (task fragments)
+	u8_t len;											// 0 if empty
+	u8_t aux;											// offset of milliseconds or task name
+	char str[slFRAG_LEN];
+} sl_frag_t;
+
+#if (slHEADROOM < (3 * slFRAG_LEN + slSGR_LEN + 16))
+	#error "slHEADROOM too small for cached header fragments"
+#endif
+
+#if (slASYNC == 0) && (slDEFERRED > 0)
+	#error "slDEFERRED requires slASYNC"
+#endif
+#if (slDEFERRED == 0) && (slTRACE > 0)
+	#error "slTRACE requires slDEFERRED"
+#endif
+
+enum { slARG_NONE, slARG_I32, slARG_I64, slARG_DBL, slARG_PTR, slARG_STR, slARG_BAD };
+
+typedef union {
+	u32_t u32;
+	u64_t u64;
+	double f64;
+	const void * ptr;
+} sl_arg_t;
+
+typedef struct {
+	u8_t count;
+	u8_t type[slMAX_ARGS];
+	sl_arg_t arg[slMAX_ARGS];
+} sl_args_t;
+
+typedef struct {
+	u32_t seq;											// ring sequence, producer/consumer handshake
+	u16_t len;											// length of rendered body, string pool or pairs
+	sl_vars_t sV;
+	const char * sdid;									// non-NULL if body holds encoded key/value pairs
+	#if (slDEFERRED > 0)
+	const char * fmt;									// non-NULL if arguments captured, not rendered
+	sl_args_t sA;
+	#endif
+	char body[slRING_BODY];								// rendered body or copied %s string pool
+} sl_slot_t;
+
+typedef struct {
+	u32_t head, tail;									// enqueue & dequeue positions
+	u32_t mask;											// slots - 1
+	sl_slot_t * slot;
+} sl_lane_t;
+
+#define slLANES				3							// EMERG..ERR, WARNING..NOTICE, INFO..DEBUG
+#define slLANE(pri)			((((pri) & 7) <= SL_SEV_ERROR) ? 0 : (((pri) & 7) <= SL_SEV_NOTICE) ? 1 : 2)
+#define slRING_TOTAL		(slLANE_HI + slLANE_MID + slRING_SLOTS)
+
+#if (slTRACE > 0)
+typedef struct {
+	u32_t seq;											// record index + 1 once complete, 0 while written
+	u64_t utc;
+	const char * fmt, * func;
+	u32_t sent;											// seq once message posted/sent to host
+	u8_t pri, core;
+	u8_t raw:1;											// arguments not captured, only format kept
+	char task[10];
+	sl_args_t sA;
+	char str[slTRACE_STR];								// copied %s arguments
+} sl_trace_t;
+
+typedef struct {
+	u32_t magic, build;									// contents only valid for same build
+	u32_t head;											// index of next record
+	sl_trace_t sE[slTRACE_SLOTS];
+} sl_tring_t;
+
+#define slTRACE_MAGIC		0x534C5431UL				// "SLT1"
+#define slTRACE_NEW			0x01						// dump records not sent to host
+#define slTRACE_ALL			0x02						// dump all records
+#endif
+
 // ####################################### Local variables #########################################
 
+static const char SyslogLetters[8] = "MACEWNID";	// eMergency, Alert, Critical, Error ... Debug
+
 static const char SyslogColors[8] = {
 	colourFG_RED,					// Emergency
 	colourFG_RED,					// Alert
@@ -72,10 +373,52 @@ static const char SyslogColors[8] = {
 	colourFG_MAGENTA,				// Info
 	colourFG_CYAN,					// Debug
 };
-static netx_t sCtx = { 0 };
-static sl_vars_t sRpt = { 0 };
+static sl_host_t sHost[slHOSTS] = { [0] = { .role = slROLE_FAILOVER, .level = slLEV_FOLLOW } };
+static u8_t HostActive = 0;								// failover group entry last used
+static int HostLevelMax = -1;							// highest explicit host level, -1 if none
+static sl_module_t sModule[slMODULE_MAX] = { 0 };
+static u8_t ModuleCount = 0;
+
+static sl_dedup_t sDedup[slDEDUP_SIZE] = { 0 };
+static u64_t TickTime = 0;								// run time of last housekeeping
+
+static sl_bucket_t sRatePri[slRATE_KEYS] = { 0 }, sRateFunc[slRATE_KEYS] = { 0 };
+static u16_t RatePri = slRATE_PRI, RateFunc = slRATE_FUNC;
+
+#if (slCON_BUF > 0)
+	static TaskHandle_t hSLcon = NULL;
+	static SemaphoreHandle_t shSLcon = NULL;			// serialises writers, console task only reads
+	static u32_t ConHead = 0, ConTail = 0;				// free running, written & read positions
+	static u32_t ConLost = 0;							// lines dropped since last notice
+	static char ConBuf[slCON_BUF];
+#endif
+
+static char HostName[slFRAG_LEN];						// prebuilt once connected, seqlock protected
+static u8_t HostNameLen = 0;
+static u32_t HostNameSeq = 0;							// odd while rebuilt, 0 until first built
+#if (slHDR_CACHE > 0)
+	static sl_frag_t sTimeHost = { 0 }, sTimeCon = { 0 };
+	static sl_frag_t sTaskFrag[slHDR_TASKS] = { 0 };
+	static char ConSGR[9][slSGR_LEN];					// per severity colour, [8] = reset
+	static u8_t ConSGRLen[9] = { 0 };
+#endif
+
+static u8_t GovDemote = 0;								// host levels currently demoted
+static u16_t GovSends = 0, GovFails = 0;
+static u32_t GovLatency = 0;
+static u64_t GovTime = 0, GovChange = 0;				// run time of window start & last level change
 #if (appLITTLEFS == 1)
 	static bool FileBuffer = 0;
+	static sl_fcur_t sCur = { .magic = slCUR_MAGIC };
+	static u32_t wrSize = 0;							// size of segment wrSeq
+	static u16_t StoreLen = 0;
+	static TickType_t StoreTime;						// tick when first record buffered
+	static u8_t StoreBuf[slSTORE_BUF];
+	static u8_t LzBuf[sizeof(sl_fblk_t) + slSTORE_BUF];	// compressed block, guarded by shSLfile
+	static u16_t LzHash[slLZ_HASH];
+	static u32_t ReplayBPS = slREPLAY_BPS, ReplayTokens = 0;
+	static u16_t ReplayMsgs = slREPLAY_MSGS;
+	static TickType_t ReplayTime = 0, CursorTime = 0;
 #endif
 
 #if (appOPTIONS == 0)
@@ -83,296 +426,3045 @@ static sl_vars_t sRpt = { 0 };
 	static u8_t consoleLevel = SL_LEV_CONSOLE;
 #endif
 
-char SLbuffer[2][slSIZEBUF] = { 0 };
+static sl_stats_t sStats = { 0 };
+#if (slMS_STATS_EMIT > 0)
+	static u64_t StatsTime = 0;							// run time of last statistics message
+#endif
+
+static u8_t HostFormat = slFMT_PAPERTRAIL, ConsoleFormat = slFMT_CON_ANSI;
+
+static u8_t Transport = slXPORT_UDP;
+static u16_t UdpBatch = slUDP_BATCH;					// datagram budget, 0 = 1 message per datagram
+static void * pvSecure = NULL;							// sec_t * for slXPORT_TLS
+
+#if (slSTAGE_SIZE > 0)
+	static u8_t StageBuf[slSTAGE_SIZE];					// encoded records, as in offline store
+	static u16_t StageLen = 0, StageCount = 0;
+	static bool StageOpen = 1;							// staging until first connection or released
+#endif
+
+char SLbuffer[slSCRATCH_COUNT][slSIZEBUF] = { 0 };
+static u32_t SLbufMap = 0;								// bit set if SLbuffer[bit#] claimed
+
+#if (slASYNC > 0)
+	static sl_slot_t sRingHi[slLANE_HI], sRingMid[slLANE_MID], sRing[slRING_SLOTS];
+	static sl_lane_t sLane[slLANES] = {
+		{ .mask = slLANE_HI - 1, .slot = sRingHi },
+		{ .mask = slLANE_MID - 1, .slot = sRingMid },
+		{ .mask = slRING_SLOTS - 1, .slot = sRing },
+	};
+	static const u8_t LaneWeight[slLANES] = { slLANE_W_HI, slLANE_W_MID, 1 };
+	static u8_t LaneCredit[slLANES];					// weighted, syslog task only
+	static u8_t LaneSched = slLANE_SCHED;
+	static u8_t RingPolicy = slOVF_DROP_NEW;
+	static TaskHandle_t hSLtask = NULL;
+	static TaskHandle_t hSLnet = NULL;					// connection attempts, never in the delivery path
+#endif
+#if (slASYNC > 0)
+	static char SLrender[slSIZEBUF];					// syslog task only, body scratch buffer
+#endif
+
+#if (slTRACE > 0)
+	static __NOINIT_ATTR sl_tring_t sTrace;				// not cleared by (soft) reset
+	static bool TraceValid = 0;							// sTrace checked since (any) reset
+	static u8_t TraceLevel = slTRACE_LEVEL;
+	static u8_t TraceReq = 0;							// slTRACE_xxx dump requested
+	static u32_t TraceDumped = 0;						// index of first record not yet dumped
+#endif
 
 // ###################################### Global variables #########################################
 
-SemaphoreHandle_t shSLsock = 0, shSLvars = 0;
+SemaphoreHandle_t shSLsock = 0, shSLvars = 0, shSLfile = 0, shSLnet = 0;
+u32_t SLlevels = slLEVELS(SL_LEV_MAX, SL_LEV_CONSOLE, SL_LEV_HOST);
 
 // ##################################### Private functions #########################################
 
 /**
- * @brief	establish connection to the selected syslog host
- * @return	1 if successful else 0
+ * @brief	count a latency in its log2 histogram bin
+ */
+static void IRAM_ATTR vSyslogHist(u32_t * pHist, u64_t Delta) {
+	int Bin = (Delta == 0) ? 0 : 64 - __builtin_clzll(Delta);
+	__atomic_fetch_add(&pHist[(Bin < slHIST_BINS) ? Bin : (slHIST_BINS - 1)], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief	claim a scratch buffer from the pool, without blocking
+ * @return	pointer to buffer, NULL if all in use
+ */
+static char * IRAM_ATTR pcSyslogScratchClaim(void) {
+	u32_t Map = __atomic_load_n(&SLbufMap, __ATOMIC_RELAXED);
+	while (1) {
+		u32_t Free = ~Map & ((1ULL << slSCRATCH_COUNT) - 1);
+		if (Free == 0)
+			return NULL;
+		u32_t Bit = Free & -Free;						// lowest free buffer
+		if (__atomic_compare_exchange_n(&SLbufMap, &Map, Map | Bit, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			return SLbuffer[__builtin_ctz(Bit)];
+	}
+}
+
+static void IRAM_ATTR vSyslogScratchFree(char * pcBuf) {
+	int Idx = (pcBuf - SLbuffer[0]) / slSIZEBUF;
+	__atomic_fetch_and(&SLbufMap, ~(1UL << Idx), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief	enter BACKOFF, doubling the period up to slMS_BACKOFF_MAX
+ * @note	caller must hold shSLsock or own the CONNECTING state
+ */
+static void IRAM_ATTR vSyslogBackoff(sl_host_t * psH) {
+	psH->backoff = (psH->backoff == 0) ? slMS_BACKOFF_MIN :
+					(psH->backoff >= slMS_BACKOFF_MAX / 2) ? slMS_BACKOFF_MAX : psH->backoff * 2;
+	psH->tNext = halTIMER_ReadRunTime() + (psH->backoff * 1000ULL);
+	if (++psH->retries >= slRESOLVE_RETRIES)			// persistent failure, maybe host moved?
+		psH->tResolve = 0;								// yes, force name resolution next attempt
+	__atomic_store_n(&psH->state, slCON_BACKOFF, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief	prebuild hostname portion of host header, rebuilt only if idSTA changed, seqlock write side
+ * @note	skipped if another writer is busy with it
+ */
+static void IRAM_ATTR vSyslogHostName(void) {
+	const char * pcName = slHOST_ID();
+	int Len = strnlen(pcName, slFRAG_LEN - 1);
+	u32_t Seq = __atomic_load_n(&HostNameSeq, __ATOMIC_RELAXED);
+	if ((Seq & 1) || (Seq && Len == HostNameLen && memcmp(HostName, pcName, Len) == 0) ||
+		__atomic_compare_exchange_n(&HostNameSeq, &Seq, Seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == 0)
+		return;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	HostNameLen = Len;
+	memcpy(HostName, pcName, Len);
+	__atomic_store_n(&HostNameSeq, Seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief	copy the prebuilt hostname, built on first use, seqlock read side
+ * @return	length copied, at most slFRAG_LEN-1, from idSTA directly if the writer stays busy
+ */
+static int IRAM_ATTR xSyslogHostNameGet(char * pcBuf) {
+	for (int Try = 0; Try < 3; ++Try) {
+		u32_t Seq = __atomic_load_n(&HostNameSeq, __ATOMIC_ACQUIRE);
+		if (Seq == 0) {
+			vSyslogHostName();
+			continue;
+		}
+		if (Seq & 1)
+			continue;
+		int Len = HostNameLen;
+		memcpy(pcBuf, HostName, Len);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&HostNameSeq, __ATOMIC_RELAXED) == Seq)
+			return Len;
+	}
+	const char * pcName = slHOST_ID();					// writer preempted, never wait for it
+	int Len = strnlen(pcName, slFRAG_LEN - 1);
+	memcpy(pcBuf, pcName, Len);
+	return Len;
+}
+
+/**
+ * @brief	resolve host name, if cached address expired, and set as numeric host for xNetOpen()
+ * @return	erSUCCESS or erFAILURE
+ * @note	TLS keeps the name as host, required for SNI & certificate host name verification
+ */
+static int xSyslogResolve(sl_host_t * psH, const char * pName) {
+	u64_t Now = halTIMER_ReadRunTime();
+	if (pName != psH->pName || Now >= psH->tResolve) {	// host changed or cached address expired
+		struct addrinfo sHints = { .ai_family = AF_INET, .ai_socktype = SOCK_DGRAM }, * psAI = NULL;
+		if (getaddrinfo(pName, NULL, &sHints, &psAI) != 0 || psAI == NULL)
+			return erFAILURE;
+		struct in_addr sAddr = ((struct sockaddr_in *) psAI->ai_addr)->sin_addr;
+		freeaddrinfo(psAI);
+		if (inet_ntop(AF_INET, &sAddr, psH->caAddr, sizeof(psH->caAddr)) == NULL)
+			return erFAILURE;
+		psH->pName = pName;
+		psH->tResolve = Now + (slRESOLVE_TTL * 1000000ULL);
+	}
+	psH->sCtx.pHost = (Transport == slXPORT_TLS) ? pName : psH->caAddr;	// numeric, no lookup by xNetOpen()
+	return erSUCCESS;
+}
+
+/**
+ * @brief	establish connection to a registry host
+ * @return	1 if connected else 0
  * @note	can only return 1 if scheduler running & L3 connected, 
+ * @note	single atomic load if UP or in BACKOFF, only 1 task at a time attempts connection per host
+ * @note	once the slNet task runs only it connects, other callers request an attempt & return 0
 */
-static bool IRAM_ATTR xSyslogConnect(void) {
-	// step 1: If scheduler not running or L2+3 not ready, fail
-	if ((xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || halEventCheckStatus(flagLX_STA) == 0)
+static bool IRAM_ATTR xSyslogConnect(sl_host_t * psH) {
+	// step 1: if already connected or in backoff, done
+	u8_t State = __atomic_load_n(&psH->state, __ATOMIC_ACQUIRE);
+	if (State != slCON_DOWN)
+		return (State == slCON_UP) ? 1 : 0;
+	#if (slASYNC > 0)
+	TaskHandle_t hNet = __atomic_load_n(&hSLnet, __ATOMIC_ACQUIRE);
+	if (hNet && xTaskGetCurrentTaskHandle() != hNet) {	// name lookup & handshake never delay delivery
+		if (xPortInIsrContext() == 0)
+			xTaskNotifyGive(hNet);
 		return 0;
+	}
+	#endif
 
-	// step 2: If unable to take the semaphore, fail
-	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE)
+	// step 2: If scheduler not running or L2+3 not ready, fail
+	if ((xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || halEventCheckStatus(flagLX_STA) == 0)
 		return 0;
 
-	// step 3: If already connected, return success
-	int iRV = 1;
-	if (sCtx.sd > 0)
+	// step 3: claim the connection attempt, then take the semaphore, shSLsock not held so sends to UP hosts continue
+	if (__atomic_compare_exchange_n(&psH->state, &State, slCON_CONNECTING, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == 0)
+		return 0;
+	if (xRtosSemaphoreTake(&shSLnet, slMS_LOCK_WAIT) == pdFALSE) {
+		__atomic_store_n(&psH->state, slCON_DOWN, __ATOMIC_RELEASE);
+		return 0;
+	}
+	int iRV = 0;
+	if (psH->role == slROLE_OFF)						// unregistered while waiting
 		goto exit;
 
-	// step 4: setup basic parameters for syslog connection
+	// step 4: setup basic parameters for syslog connection, entry 0 from options, others as registered
+	int Port = (Transport == slXPORT_TLS) ? slPORT_TLS : (Transport == slXPORT_TCP) ? slPORT_TCP : IP_PORT_SYSLOG_UDP;
+	const char * pName = psH->caName;
+	if (psH == &sHost[0]) {
 	#if (appOPTIONS > 0)
 		int Idx = xOptionGet(ioHostSLOG);				// if WL connected, NVS vars must be initialized (in stage 2.0/1)
-		sCtx.pHost = HostInfo[Idx].pName;
-		sCtx.sa_in.sin_port = htons(HostInfo[Idx].Port ? HostInfo[Idx].Port : IP_PORT_SYSLOG_UDP);
+		pName = HostInfo[Idx].pName;
+		Port = HostInfo[Idx].Port ? HostInfo[Idx].Port : Port;
 	#else
-		sCtx.pHost = slDEFAULT_HOST;				// options not part of application ?
-		sCtx.sa_in.sin_port = htons(slDEFAULT_PORT);// get from app_config...
+		pName = slDEFAULT_HOST;							// options not part of application ?
+		Port = slDEFAULT_PORT;							// get from app_config...
 	#endif
-	sCtx.flags = SO_REUSEADDR;
-	sCtx.sa_in.sin_family = AF_INET;
-	sCtx.c.type = SOCK_DGRAM;
-	sCtx.c.NoSyslog = 1;								// mark as syslog port, so as not to recurse in xNetSyslog
+	} else if (psH->port) {
+		Port = psH->port;
+	}
+	psH->sCtx.sa_in.sin_port = htons(Port);
+	psH->sCtx.flags = SO_REUSEADDR;
+	psH->sCtx.sa_in.sin_family = AF_INET;
+	psH->sCtx.c.type = (Transport == slXPORT_UDP) ? SOCK_DGRAM : SOCK_STREAM;
+	psH->sCtx.psSec = (Transport == slXPORT_TLS) ? pvSecure : NULL;
+	psH->sCtx.c.NoSyslog = 1;							// mark as syslog port, so as not to recurse in xNetSyslog
 
-	// step 5: before openng, close any zombie sockets
-	xNetCloseDuplicates(sCtx.sa_in.sin_port);
+	// step 5: resolve, if not cached, & before opening close any zombie sockets
+	if (xSyslogResolve(psH, pName) < erSUCCESS)
+		goto exit;
+	xNetCloseDuplicates(psH->sCtx.sa_in.sin_port);
 
 	// step 6: open socket connection... AMM check if blocking really required!!!
-	if ((xNetOpen(&sCtx) < erSUCCESS) || 				// open failed ?
-		(xNetSetRecvTO(&sCtx, flagXNET_NONBLOCK) < erSUCCESS)) {	// RX timeout failed ?
-		xNetClose(&sCtx);								// try closing
-		iRV = 0;										// return failure...
+	if ((xNetOpen(&psH->sCtx) < erSUCCESS) || 		// open failed ?
+		(xNetSetRecvTO(&psH->sCtx, flagXNET_NONBLOCK) < erSUCCESS)) {	// RX timeout failed ?
+		xNetClose(&psH->sCtx);							// try closing
+		goto exit;
 	}
+	iRV = 1;
+	psH->backoff = psH->retries = 0;
+	vSyslogHostName();
+	slSTAT_INC(Reconnects);
+	__atomic_store_n(&psH->state, slCON_UP, __ATOMIC_RELEASE);
 exit:
-	xRtosSemaphoreGive(&shSLsock);
+	if (iRV == 0)
+		vSyslogBackoff(psH);
+	xRtosSemaphoreGive(&shSLnet);
 	return iRV;											// and return status accordingly
 }
 
-#define formatREPEATED		DRAM_STR("Repeated %dx")
+#define formatREPEATED		DRAM_STR("Repeated %dx in %lums")
+#define formatCONSOLE0		DRAM_STR("%!.3R %d %s %s ")		// 	UTC, core#, task, function
 #define formatCONSOLE1		DRAM_STR("%C%!.3R %d %s %s ")	// 	ANSI colour, UTC, core#, task, function
 #define formatCONSOLE2		DRAM_STR("%C" strNL)
-#define formatPAPERTRAIL	DRAM_STR("<%u>1 %.3R %s %s/%d %s - - ")		/* papertrailapp.com "main/0/Devices" */
-#define formatRFC5424		DRAM_STR("<%d>1 %.3R %s %s %d %s - ")		/* RFC compliant "main 0 Devices" */
+#define formatCONSOLE3		DRAM_STR("%c %llu %s ")			//	severity letter, run time mS, function
+#define formatHOSTPRE		DRAM_STR("<%u>1 %.3R ")			// PRI, UTC ahead of hostname
+#define formatPAPERTRAIL	DRAM_STR(" %s/%d %s - - ")		/* papertrailapp.com "main/0/Devices" */
+#define formatRFC5424		DRAM_STR(" %s %d %s - ")		/* RFC compliant "main 0 Devices" */
+#define formatTIMEHOST		DRAM_STR("%.3R")
+#define formatTIMECON		DRAM_STR("%!.3R")
+
+static const char * const HostFormats[] = { formatPAPERTRAIL, formatRFC5424 };
+
+// header cache fragments per kind (slFMT_PAPERTRAIL, slFMT_RFC5424, slFRAG_CONSOLE), task ahead of function
+static const char * const TaskFormats[] = { DRAM_STR(" %s/%d "), DRAM_STR(" %s %d "), DRAM_STR(" %d %s ") };
+static const char * const FuncTails[] = { DRAM_STR(" - - "), DRAM_STR(" - "), DRAM_STR(" ") };
 
 static int IRAM_ATTR xSyslogRemoveTerminators(char * pBuf, int xLen) {
-	while  (isspace((int) pBuf[xLen - 1]) != 0)
+	while  (xLen && isspace((int) pBuf[xLen - 1]) != 0)
 		pBuf[--xLen] = CHR_NUL;							// remove terminating white space character(s)
 	return xLen;
 }
 
-static void IRAM_ATTR xvSyslogConsole(sl_vars_t * psV, const char * format, va_list vaList) {
-	report_t sRpt = {
-		.pcAlloc = &SLbuffer[psV->core][0],
-		.pcBuf = &SLbuffer[psV->core][0],
-		.Size = repSIZE_SET(sBUFFER,sgrANSI,0,0,slSIZEBUF)
-	 };
-	int xLen = xReport(&sRpt, formatCONSOLE1, xpfCOL(SyslogColors[psV->pri&7],0), psV->run, psV->core, psV->task, psV->func);
-	if (format)	xLen += xvReport(&sRpt, format, vaList);
-	else		xLen += xReport(&sRpt, formatREPEATED, psV->count);
-	xLen += xReport(&sRpt, formatCONSOLE2, xpfCOL(attrRESET,0));
-	xStdioWrite(STDOUT_FILENO, sRpt.pcAlloc, xLen);		// use low level unbuffered API
-}
-
-static void IRAM_ATTR xvSyslogHost(sl_vars_t * psV, const char * format, va_list vaList) {
-	report_t sRpt = {
-		.pcAlloc = &SLbuffer[psV->core][0],
-		.pcBuf = &SLbuffer[psV->core][0],
-		.Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slSIZEBUF)
-	 };
-	if (idSTA[0] == 0)									/* very early message, not WIFI yet */
-		strcpy((char*)idSTA, UNKNOWNMACAD);				/* insert MAC address placemaker */
-	int xLen = xReport(&sRpt, formatPAPERTRAIL, psV->pri, psV->utc, idSTA, psV->task, psV->core, psV->func);
-	if (format)	xLen += xvReport(&sRpt, format, vaList);
-	else		xLen += xReport(&sRpt, formatREPEATED, psV->count);
-
-	// If check scheduler and LxSTA, take semaphore and if all ok, send the message
-	int iRV = erFAILURE;
-	if (xSyslogConnect() && xRtosSemaphoreTake(&shSLsock, pdMS_TO_TICKS(slMS_LOCK_WAIT)) == pdTRUE) {
-		xLen = xSyslogRemoveTerminators(sRpt.pcAlloc, xLen);
-		iRV = xNetSend(&sCtx, (u8_t *)sRpt.pcAlloc, xLen);
-		if (iRV >= erSUCCESS) {							/* message successfully sent? */
-			sCtx.maxTx = (iRV > sCtx.maxTx) ? iRV : sCtx.maxTx;	/* yes, update running stats */
-		} else {										/* no, close the connection */
-			xNetClose(&sCtx);							/* iRV already set for persisting */
-		}
-		xRtosSemaphoreGive(&shSLsock);
-	}
-	#if (appLITTLEFS > 0)		/* HOST not accessible try send to LFS if available ***********/
-	if (iRV < erSUCCESS && halEventCheckDevice(devMASK_LFS)) {
-		if (sRpt.pcAlloc[xLen-1] != CHR_LF) {			// yes, if last character not a LF
-			sRpt.pcAlloc[xLen++] = CHR_LF;				// append LF for later fgets()
-			sRpt.pcAlloc[xLen] = CHR_NUL;				// and terminate
-		}
-		xFileSysFileWrite(slFILENAME, O_WRONLY|O_APPEND, sRpt.pcAlloc, xLen);
-		FileBuffer = 1;
-	}
-	#endif
+/**
+ * @brief	unsigned decimal conversion
+ * @return	number of digits
+ */
+static int IRAM_ATTR xSyslogU64toA(char * pcBuf, u64_t Val) {
+	char caTmp[20];
+	int Len = 0;
+	do {
+		caTmp[Len++] = '0' + (Val % 10);
+		Val /= 10;
+	} while (Val);
+	for (int i = 0; i < Len; ++i)
+		pcBuf[i] = caTmp[Len - 1 - i];
+	return Len;
 }
 
-// ###################################### Public functions #########################################
+static u32_t IRAM_ATTR xSyslogHash(u32_t Hash, const void * pvData, size_t Size) {
+	const u8_t * pU8 = pvData;
+	while (Size--)
+		Hash = (Hash ^ *pU8++) * 16777619UL;			// FNV-1a
+	return Hash;
+}
 
-int xSyslogCheckDuplicates(int sock, struct sockaddr_in * addr) {
-	// Check for same port but sockets not same as current context
-	if ((htons(addr->sin_port) == sCtx.sa_in.sin_port) && (sock != sCtx.sd)) {
-		close(sock);
-		return 1;
-	}
-	return 0;
+/**
+ * @brief	hash of the call site, task, function, format & line, all link time constants
+ */
+static u32_t IRAM_ATTR xSyslogHashVars(sl_vars_t * psV, const char * format, int Line) {
+	const void * Ptrs[4] = { psV->task, psV->func, format, (const void *) (uintptr_t) Line };
+	return xSyslogHash(2166136261UL, Ptrs, sizeof(Ptrs));
 }
 
-int xSyslogGetConsoleLevel(void) {
-#if (appOPTIONS > 0)
-	int iRV = xOptionGet(ioSLOGhi);
-	return iRV ? iRV : SL_LEV_CONSOLE;
-#else
-	return consoleLevel;
-#endif
+/**
+ * @brief	render a message body into a buffer reserved with slHEADROOM ahead & slTAILROOM after
+ * @return	length of body rendered, truncated to Size-1
+ */
+static int IRAM_ATTR xvSyslogBody(char * pcBody, int Size, const char * format, va_list vaList) {
+	report_t sRpt = { .pcAlloc = pcBody, .pcBuf = pcBody, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,Size) };
+	int xLen = format ? xvReport(&sRpt, format, vaList) : 0;
+	return (xLen < 0) ? 0 : (xLen >= Size) ? (Size - 1) : xLen;
 }
 
-int xSyslogGetHostLevel(void) {
-#if (appOPTIONS > 0)
-	int iRV = xOptionGet(ioSLhost);
-	return iRV ? iRV : SL_LEV_HOST;
-#else
-	return hostLevel;
-#endif
+static int IRAM_ATTR xSyslogBody(char * pcBody, int Size, const char * format, ...) {
+	va_list vaList;
+	va_start(vaList, format);
+	int xLen = xvSyslogBody(pcBody, Size, format, vaList);
+	va_end(vaList);
+	return xLen;
 }
 
-void vSyslogSetConsoleLevel(int Level) {
-	if (Level > SL_LEV_MAX)
-		Level = SL_LEV_MAX;
-#if (appOPTIONS > 0)
-	vOptionSet(ioSLOGhi, Level);
-#else
-	consoleLevel = Level;
-#endif
+/**
+ * @brief	move a header rendered at the start of the headroom to immediately ahead of the body
+ * @return	pointer to start of header+body
+ */
+static char * IRAM_ATTR pcSyslogPrepend(char * pcBody, int xHdr) {
+	xHdr = (xHdr < 0) ? 0 : (xHdr >= slHEADROOM) ? (slHEADROOM - 1) : xHdr;
+	memmove(pcBody - xHdr, pcBody - slHEADROOM, xHdr);
+	return pcBody - xHdr;
 }
 
-// In the case where the log level is set to DEBUG in ESP-IDF the volume of messages being generated
-// could flood the IP stack and cause watchdog timeouts. Even if the timeout is changed from 5 to 10
-// seconds the crash can still occur. In order to minimise load on the IP stack the minimum severity
-// level should be set to NOTICE.
+/**
+ * @brief	render console header in full, start of headroom
+ */
+static int IRAM_ATTR xSyslogConHeaderFull(sl_vars_t * psV, char * pcBuf) {
+	report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrANSI,0,0,slHEADROOM) };
+	if (ConsoleFormat == slFMT_CON_ANSI)
+		return xReport(&sRpt, formatCONSOLE1, xpfCOL(SyslogColors[psV->pri&7],0), psV->run, psV->core, psV->task, psV->func);
+	if (ConsoleFormat == slFMT_CON_COMPACT)
+		return xReport(&sRpt, formatCONSOLE3, SyslogLetters[psV->pri&7], psV->run / 1000ULL, psV->func);
+	return xReport(&sRpt, formatCONSOLE0, psV->run, psV->core, psV->task, psV->func);
+}
 
-void vSyslogSetHostLevel(int Level) {
-	if (Level > SL_LEV_MAX)
-		Level = SL_LEV_MAX;
-#if (appOPTIONS > 0)
-	vOptionSet(ioSLhost, Level);
-#else
-	hostLevel = Level;
-#endif
+/**
+ * @brief	render host header in full, start of headroom
+ * @param[out]	*pxPre offset & *pxName length of hostname
+ */
+static int IRAM_ATTR xSyslogHostHeaderFull(sl_vars_t * psV, char * pcBuf, int * pxPre, int * pxName) {
+	report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slHEADROOM) };
+	*pxPre = xReport(&sRpt, formatHOSTPRE, psV->pri, psV->utc);
+	*pxName = xReport(&sRpt, "%s", slHOST_ID());
+	return *pxPre + *pxName + xReport(&sRpt, HostFormats[HostFormat], psV->task, psV->core, psV->func);
 }
 
-#if (appLITTLEFS == 1)
+#if (slHDR_CACHE > 0)
 /**
- * @brief	Send contents (if any) of syslog offline buffer file to host
+ * @brief	copy a cached fragment, seqlock read side
+ * @return	length copied, 0 if not cached or updated concurrently
  */
-void vSyslogFileSend(void) {
-	// step 1: check if scheduler running, LxSTA up and connected
-	if (xSyslogConnect() == 0)
-		return;
-	// step 2: check if anything there to send
-	if (xFileSysGetFileSize(slFILENAME) <= 0)
+static int IRAM_ATTR xSyslogFragGet(sl_frag_t * psF, const void * Key, u32_t Tag, char * pcBuf, u8_t * pAux) {
+	u32_t Seq = __atomic_load_n(&psF->seq, __ATOMIC_ACQUIRE);
+	if ((Seq & 1) || psF->len == 0 || psF->key != Key || psF->tag != Tag)
+		return 0;
+	int Len = psF->len;
+	*pAux = psF->aux;
+	memcpy(pcBuf, psF->str, Len);
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return (__atomic_load_n(&psF->seq, __ATOMIC_RELAXED) == Seq) ? Len : 0;
+}
+
+/**
+ * @brief	update a cached fragment, skipped if another writer is busy with it
+ */
+static void IRAM_ATTR vSyslogFragPut(sl_frag_t * psF, const void * Key, u32_t Tag, const char * pcStr, int Len, int Aux) {
+	u32_t Seq = __atomic_load_n(&psF->seq, __ATOMIC_RELAXED);
+	if ((Seq & 1) || Len >= slFRAG_LEN ||
+		__atomic_compare_exchange_n(&psF->seq, &Seq, Seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == 0)
 		return;
-	// step 3: protect the whole operation
-	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE)	/* semaphore taken? */
-		return;														/* no, return for now */
-	// step 4: try to lock file for read [and delete/unlink]
-	if (xRtosSemaphoreTake(&shLFSmux, slMS_LOCK_WAIT) == pdFALSE)
-		goto exit0;
-	// step 5: try to open the file for read
-	FILE *fp = fopen(slFILENAME, "r");
-	if (fp == NULL)										/* successfully opened file? */
-		goto exit1;										/* no, release both semaphores and return */
-
-	// step 6: rewind and start sending
-	int iRV = erSUCCESS;								// default to force file deletion at exit
-	char * pBuf = malloc(slSIZEBUF);
-	while (fgets(pBuf, slSIZEBUF, fp) != NULL) {
-		// step 6a: fix placeholder MAC if required
-		char * pTmp = strstr(pBuf, UNKNOWNMACAD);		// Check if early message ie no MAC address
-		if (pTmp)										// if UNKNOWNMACAD marker is present
-			memcpy(pTmp, idSTA, lenMAC_ADDRESS*2);		// replace with actual MAC/hostname
-
-		// step 6b: trim extra terminators from the end
-		int xLen = strlen(pBuf);
-		xLen = xSyslogRemoveTerminators(pBuf, xLen);	// remove terminating [CR]LF
-		if (xLen == 0)									// if nothing left to send (was just terminators...)
-			break;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	psF->key = Key;
+	psF->tag = Tag;
+	psF->len = Len;
+	psF->aux = Aux;
+	memcpy(psF->str, pcStr, Len);
+	__atomic_store_n(&psF->seq, Seq + 2, __ATOMIC_RELEASE);
+}
 
-		// step 6c: send whatever remains of message (if any)
-		iRV = xNetSend(&sCtx, (u8_t *)pBuf, xLen);		// send contents of buffer
-		if (iRV <= 0) {									// message send failed?
-			xNetClose(&sCtx);							// yes, close connection
-			break;										// and abort sending
+/**
+ * @brief	render a timestamp from the per second cache, only the milliseconds patched
+ * @return	length rendered, pcBuf must have slFRAG_LEN available
+ */
+static int IRAM_ATTR xSyslogTime(sl_frag_t * psF, const char * pcFmt, u64_t Time, char * pcBuf) {
+	u32_t Sec = Time / 1000000ULL, mSec = (Time / 1000ULL) % 1000;
+	u8_t Ofs;
+	int Len = xSyslogFragGet(psF, NULL, Sec, pcBuf, &Ofs);
+	if (Len == 0) {										// new second, render with .000 & locate it
+		report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slFRAG_LEN) };
+		Len = xReport(&sRpt, pcFmt, Sec * 1000000ULL);
+		Len = (Len < 0) ? 0 : (Len >= slFRAG_LEN) ? (slFRAG_LEN - 1) : Len;
+		for (Ofs = Len; Ofs && pcBuf[Ofs - 1] != '.'; --Ofs);
+		if (Ofs == 0 || (Ofs + 3) > Len || memcmp(&pcBuf[Ofs], "000", 3) != 0) {	// not patchable?
+			sRpt = (report_t) { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slFRAG_LEN) };
+			Len = xReport(&sRpt, pcFmt, Time);			// yes, render in full
+			return (Len < 0) ? 0 : (Len >= slFRAG_LEN) ? (slFRAG_LEN - 1) : Len;
 		}
-		vTaskDelay(pdMS_TO_TICKS(slMS_FILESEND_DLY));	// ensure WDT gets fed....
+		vSyslogFragPut(psF, NULL, Sec, pcBuf, Len, Ofs);
 	}
-	free(pBuf);											// always free buffer
+	pcBuf[Ofs] = '0' + (mSec / 100);
+	pcBuf[Ofs + 1] = '0' + ((mSec / 10) % 10);
+	pcBuf[Ofs + 2] = '0' + (mSec % 10);
+	return Len;
+}
 
-	// step 7: close the file and delete if successfully sent (add EOF and error checks to make sure?)
-	fclose(fp);											// always close the file
-	if (iRV >= erSUCCESS) {								// if last send was successful
-		FileBuffer = 0;									// clear flag used to check for sending
-		unlink(slFILENAME);								// delete the file
-	}
-exit1:
-	xRtosSemaphoreGive(&shLFSmux);
-exit0:
-	xRtosSemaphoreGive(&shSLsock);
+/**
+ * @brief	render task & core fragment from the per task cache
+ * @param[in]	Kind slFMT_PAPERTRAIL or slFMT_RFC5424 (host) or slFRAG_CONSOLE
+ * @return	length rendered, pcBuf must have slFRAG_LEN available
+ */
+static int IRAM_ATTR xSyslogTaskFrag(const char * pcTask, int Core, int Kind, char * pcBuf) {
+	u32_t Tag = Core | (Kind << 8);
+	sl_frag_t * psF = &sTaskFrag[(((uintptr_t) pcTask >> 2) ^ Tag) % slHDR_TASKS];
+	int xTask = strnlen(pcTask, slFRAG_LEN);
+	int xFrag = xTask + ((Core > 9) ? 5 : 4);			// 3 separators & core digit(s)
+	u8_t Ofs;
+	int Len = xSyslogFragGet(psF, pcTask, Tag, pcBuf, &Ofs);
+	if (Len == xFrag && memcmp(&pcBuf[Ofs], pcTask, xTask) == 0)
+		return Len;										// hit, name checked in case task (TCB) reused
+	report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slFRAG_LEN) };
+	if (Kind == slFRAG_CONSOLE)
+		Len = xReport(&sRpt, TaskFormats[Kind], Core, pcTask);
+	else
+		Len = xReport(&sRpt, TaskFormats[Kind], pcTask, Core);
+	Len = (Len < 0) ? 0 : (Len >= slFRAG_LEN) ? (slFRAG_LEN - 1) : Len;
+	Ofs = (Kind == slFRAG_CONSOLE) ? (Len - 1 - xTask) : 1;
+	if (Len == xFrag)									// not truncated?
+		vSyslogFragPut(psF, pcTask, Tag, pcBuf, Len, Ofs);
+	return Len;
 }
 
-void vSyslogFileCheckSize(void) {
-	ssize_t Size = xFileSysGetFileSize(slFILENAME);
-	if (Size > slFILESIZE) {							// if file size > slFILESIZE
-		unlink(slFILENAME);								// remove file
-		Size = 0;										// discard content
+/**
+ * @brief	append function name, truncated to fit Space, then the NILVALUE(s) or separator
+ */
+static int IRAM_ATTR xSyslogFuncTail(char * pcBuf, int Space, const char * pcFunc, int Kind) {
+	int xTail = strlen(FuncTails[Kind]), xFunc = strlen(pcFunc);
+	if ((xFunc + xTail) >= Space)
+		xFunc = (Space > (xTail + 1)) ? (Space - xTail - 1) : 0;
+	memcpy(pcBuf, pcFunc, xFunc);
+	memcpy(pcBuf + xFunc, FuncTails[Kind], xTail);
+	return xFunc + xTail;
+}
+
+/**
+ * @brief	copy console colour sequence, rendered once per severity, Idx 8 = reset
+ */
+static int IRAM_ATTR xSyslogSGR(int Idx, char * pcBuf) {
+	int Len = __atomic_load_n(&ConSGRLen[Idx], __ATOMIC_ACQUIRE);
+	if (Len == 0) {										// concurrent renders produce the same bytes
+		report_t sRpt = { .pcAlloc = ConSGR[Idx], .pcBuf = ConSGR[Idx], .Size = repSIZE_SET(sBUFFER,sgrANSI,0,0,slSGR_LEN) };
+		Len = xReport(&sRpt, "%C", xpfCOL((Idx < 8) ? SyslogColors[Idx] : attrRESET, 0));
+		Len = (Len < 0) ? 0 : (Len >= slSGR_LEN) ? (slSGR_LEN - 1) : Len;
+		__atomic_store_n(&ConSGRLen[Idx], Len, __ATOMIC_RELEASE);
 	}
-	FileBuffer = (Size > 0) ? 1 : 0;					// set flag if anything in file
+	memcpy(pcBuf, ConSGR[Idx], Len);
+	return Len;
 }
 #endif
 
-void IRAM_ATTR xvSyslog(int MsgPRI, const char *FuncID, const char *format, va_list vaList) {
-	// step 0: check if anything in file that needs sending, do so ASAP
-	#if (appLITTLEFS == 1)
-	if (FileBuffer)
-		vSyslogFileSend();
+/**
+ * @brief	render "<PRI>1 TIMESTAMP " ahead of the hostname
+ * @return	length rendered
+ */
+static int IRAM_ATTR xSyslogHostPre(char * pcBuf, int Pri, u64_t Utc) {
+	#if (slHDR_CACHE > 0)
+	char * pc = pcBuf;
+	*pc++ = '<';
+	if (Pri >= 100)
+		*pc++ = '0' + (Pri / 100);
+	if (Pri >= 10)
+		*pc++ = '0' + ((Pri / 10) % 10);
+	*pc++ = '0' + (Pri % 10);
+	memcpy(pc, ">1 ", 3);
+	pc += 3;
+	pc += xSyslogTime(&sTimeHost, formatTIMEHOST, Utc, pc);
+	*pc++ = ' ';
+	return pc - pcBuf;
+	#else
+	report_t sRpt = { .pcAlloc = pcBuf, .pcBuf = pcBuf, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slHEADROOM) };
+	return xReport(&sRpt, formatHOSTPRE, Pri, Utc);
 	#endif
+}
 
-	// step 1: check if message priority outside console threshold
-	if ((MsgPRI & 7) > xSyslogGetConsoleLevel())
-		return;
+/**
+ * @brief	render host header, from cached fragments if enabled, start of headroom
+ * @param[out]	*pxPre offset & *pxName length of hostname
+ */
+static int IRAM_ATTR xSyslogHostHeader(sl_vars_t * psV, char * pcBuf, int * pxPre, int * pxName) {
+	#if (slHDR_CACHE > 0)
+	int xHdr = *pxPre = xSyslogHostPre(pcBuf, psV->pri, psV->utc);
+	*pxName = xSyslogHostNameGet(pcBuf + xHdr);
+	xHdr += *pxName;
+	xHdr += xSyslogTaskFrag(psV->task, psV->core, HostFormat, pcBuf + xHdr);
+	return xHdr + xSyslogFuncTail(pcBuf + xHdr, slHEADROOM - xHdr, psV->func, HostFormat);
+	#else
+	return xSyslogHostHeaderFull(psV, pcBuf, pxPre, pxName);
+	#endif
+}
 
-	// step 2: handle state of scheduler and obtain the task name
-	sl_vars_t sMsg;
-	sMsg.pri = MsgPRI;
-	sMsg.func = (FuncID == NULL) ? "null" : (*FuncID == 0) ? "empty" : FuncID;
-	sMsg.count = 0;
-	sMsg.core = esp_cpu_get_core_id();
-	sMsg.run = halTIMER_ReadRunTime();
-	sMsg.utc = sTSZ.usecs;
-	sMsg.task = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? DRAM_STR("preX") : pcTaskGetName(NULL);	
-
-	// step 3: calculate CRC for current message 
-	crcprintfx(&sMsg.crc, DRAM_STR("%s %s "), sMsg.task, sMsg.func);	// "Task Function "
-	vcrcprintfx(&sMsg.crc, format, vaList);				//  add message parameters etc"
-
-	// step 4: semaphore protect all local variables
-	xRtosSemaphoreTake(&shSLvars, portMAX_DELAY);
-	if (sRpt.crc == sMsg.crc && sRpt.pri == sMsg.pri) {	// CRC & PRI same as previous message ?
-		u16_t Count = ++sRpt.count;						// Yes, increment the repeat counter
-		sRpt = sMsg;									// current message info now basis of next repeat
-		sRpt.count = Count;								// and update with incremented count
-		xRtosSemaphoreGive(&shSLvars);					// variable changes done, unlock and return
-		return;
+/**
+ * @brief	render console header, from cached fragments if enabled, start of headroom
+ */
+static int IRAM_ATTR xSyslogConHeader(sl_vars_t * psV, char * pcBuf) {
+	#if (slHDR_CACHE > 0)
+	char * pc = pcBuf;
+	if (ConsoleFormat == slFMT_CON_COMPACT) {
+		*pc++ = SyslogLetters[psV->pri & 7];
+		*pc++ = ' ';
+		pc += xSyslogU64toA(pc, psV->run / 1000ULL);
+		*pc++ = ' ';
+		return (pc - pcBuf) + xSyslogFuncTail(pc, slHEADROOM - (pc - pcBuf), psV->func, slFRAG_CONSOLE);
 	}
-	// Different CRC and/or PRI
-	sl_vars_t sPrv = sRpt;								// save previous repeat values for message creation
-	sRpt = sMsg;										// save as repeat test for next message
-	xRtosSemaphoreGive(&shSLvars);						// variable changes done, unlock and continue
-	va_fake_t vaFake = { .pa = NULL };
-
-	// step 5: handle console message(s)
-	if (sPrv.count)										// if previously repeated messages
-		xvSyslogConsole(&sPrv, NULL, vaFake.va);		// send repeated message warning to console
-	xvSyslogConsole(&sMsg, format, vaList);				// send current message to console	
+	if (ConsoleFormat == slFMT_CON_ANSI)
+		pc += xSyslogSGR(psV->pri & 7, pc);
+	pc += xSyslogTime(&sTimeCon, formatTIMECON, psV->run, pc);
+	pc += xSyslogTaskFrag(psV->task, psV->core, slFRAG_CONSOLE, pc);
+	return (pc - pcBuf) + xSyslogFuncTail(pc, slHEADROOM - (pc - pcBuf), psV->func, slFRAG_CONSOLE);
+	#else
+	return xSyslogConHeaderFull(psV, pcBuf);
+	#endif
+}
 
-	// step 6: handle host message(s)
-	if ((MsgPRI & 7) <= xSyslogGetHostLevel()) {		// filter based on higher priorities
-		if (sPrv.count)									// if previously repeated messages		
-			xvSyslogHost(&sPrv, NULL, vaFake.va);		// send repeated message warning to host
-		xvSyslogHost(&sMsg, format, vaList);			// send current message to host
+#if (slCON_BUF > 0)
+/**
+ * @brief	copy into the console buffer at Head, wrapping as required
+ */
+static void IRAM_ATTR vSyslogConCopy(u32_t Head, const char * pcSrc, int xLen) {
+	u32_t Ofs = Head & (slCON_BUF - 1);
+	int Part = ((slCON_BUF - Ofs) < xLen) ? (slCON_BUF - Ofs) : xLen;
+	memcpy(&ConBuf[Ofs], pcSrc, Part);
+	memcpy(ConBuf, pcSrc + Part, xLen - Part);
+}
+
+/**
+ * @brief	append a line to the console buffer, preceded by a notice if lines were dropped
+ * @return	1 if buffered, 0 if dropped as buffer full or busy, never waits for the UART
+ */
+static bool IRAM_ATTR bSyslogConPut(const char * pcMsg, int xLen) {
+	if (xRtosSemaphoreTake(&shSLcon, slMS_CON_WAIT) == pdFALSE)
+		return 0;
+	u32_t Head = ConHead;
+	u32_t Free = slCON_BUF - (Head - __atomic_load_n(&ConTail, __ATOMIC_ACQUIRE));
+	char caNote[40];
+	int xNote = 0;
+	if (ConLost) {
+		memcpy(caNote, "... ", 4);
+		xNote = 4 + xSyslogU64toA(caNote + 4, ConLost);
+		memcpy(caNote + xNote, " lines dropped" strNL, sizeof(" lines dropped" strNL) - 1);
+		xNote += sizeof(" lines dropped" strNL) - 1;	// strNL is CR+LF or LF only
+	}
+	bool bOK = (xNote + xLen) <= Free;
+	if (bOK) {
+		vSyslogConCopy(Head, caNote, xNote);
+		vSyslogConCopy(Head + xNote, pcMsg, xLen);
+		__atomic_store_n(&ConHead, Head + xNote + xLen, __ATOMIC_RELEASE);
+		ConLost = 0;
+	} else {
+		++ConLost;
+	}
+	xRtosSemaphoreGive(&shSLcon);
+	if (bOK)
+		xTaskNotifyGive(hSLcon);
+	return bOK;
+}
+
+/**
+ * @brief	console task, writes buffered lines to the UART in as few writes as possible
+ */
+static void vSyslogConTask(void * pvPara) {
+	u32_t Tail = __atomic_load_n(&ConTail, __ATOMIC_RELAXED);
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		u32_t Head;
+		while ((Head = __atomic_load_n(&ConHead, __ATOMIC_ACQUIRE)) != Tail) {
+			u32_t Ofs = Tail & (slCON_BUF - 1);
+			u32_t Len = Head - Tail;
+			Len = (Len > (slCON_BUF - Ofs)) ? (slCON_BUF - Ofs) : Len;	// up to the wrap
+			xStdioWrite(STDOUT_FILENO, &ConBuf[Ofs], Len);
+			Tail += Len;
+			__atomic_store_n(&ConTail, Tail, __ATOMIC_RELEASE);
+		}
+	}
+}
+#endif
+
+static void IRAM_ATTR vSyslogConsole(sl_vars_t * psV, char * pcBody, int xLen) {
+	int xHdr = xSyslogConHeader(psV, pcBody - slHEADROOM);
+	char * pcMsg = pcSyslogPrepend(pcBody, xHdr);
+	xLen += pcBody - pcMsg;
+	#if (slHDR_CACHE > 0)
+	if (ConsoleFormat == slFMT_CON_ANSI)
+		xLen += xSyslogSGR(8, pcMsg + xLen);
+	memcpy(pcMsg + xLen, strNL, sizeof(strNL) - 1);
+	xLen += sizeof(strNL) - 1;
+	#else
+	report_t sTail = { .pcAlloc = pcBody, .pcBuf = pcMsg + xLen, .Size = repSIZE_SET(sBUFFER,sgrANSI,0,0,slTAILROOM) };
+	if (ConsoleFormat == slFMT_CON_ANSI)
+		xLen += xReport(&sTail, formatCONSOLE2, xpfCOL(attrRESET,0));
+	else
+		xLen += xReport(&sTail, strNL);
+	#endif
+	#if (slCON_BUF > 0)
+	if (__atomic_load_n(&hSLcon, __ATOMIC_ACQUIRE) && xPortInIsrContext() == 0) {
+		if (bSyslogConPut(pcMsg, xLen) == 0) {			// buffer full, never block on the UART
+			slSTAT_INC(ConDrops);
+			return;
+		}
+	} else
+	#endif
+	xStdioWrite(STDOUT_FILENO, pcMsg, xLen);			// use low level unbuffered API
+	slSTAT_INC(SinkMsgs[slSINK_CONSOLE]);
+	slSTAT_ADD(SinkBytes[slSINK_CONSOLE], xLen);
+}
+
+#if (appLITTLEFS == 1)
+static void vSyslogStoreName(char * pcName, u32_t Seq) {
+	snprintf(pcName, 24, slSEG_NAME, (int) (Seq % slSEG_COUNT));
+}
+
+static void vSyslogIndexName(char * pcName, u32_t Seq) {
+	snprintf(pcName, 24, slIDX_NAME, (int) (Seq % slSEG_COUNT));
+}
+
+/**
+ * @brief	remove a segment & its index
+ */
+static void vSyslogStoreUnlink(u32_t Seq) {
+	char caName[24];
+	vSyslogStoreName(caName, Seq);
+	unlink(caName);
+	vSyslogIndexName(caName, Seq);
+	unlink(caName);
+}
+
+/**
+ * @brief	build the index entry for a block of records, first timestamp & severities present
+ */
+static void vSyslogIndexBuild(const u8_t * pU8, int Len, u32_t Ofs, sl_fidx_t * psI) {
+	*psI = (sl_fidx_t) { .ofs = Ofs };
+	for (int i = 0; (i + (int) sizeof(sl_frec_t)) <= Len; ) {
+		sl_frec_t sRec;
+		memcpy(&sRec, &pU8[i], sizeof(sRec));
+		if (psI->count == 0)
+			psI->sec = sRec.sec;
+		psI->sev |= 1 << (sRec.pri & 7);
+		psI->count += (psI->count < 0xFF) ? 1 : 0;
+		i += sizeof(sRec) + sRec.len;
+	}
+}
+
+static void vSyslogStoreSaveCursor(void) {
+	FILE * fp = fopen(slCUR_NAME, "wb");
+	if (fp == NULL)
+		return;
+	fwrite(&sCur, sizeof(sCur), 1, fp);
+	fclose(fp);
+}
+
+/**
+ * @brief	compress a block of records, LZ77 style, matches limited to the block itself
+ * @return	compressed length, 0 if not smaller than the input
+ * @note	0LLLLLLL = L+1 literals follow, 1LLLLLDD DDDDDDDD = copy L+3 bytes from D+1 bytes back
+ * @note	caller must hold shSLfile (LzHash)
+ */
+static int xSyslogLzPack(const u8_t * pIn, int Len, u8_t * pOut) {
+	memset(LzHash, 0xFF, sizeof(LzHash));
+	int iIn = 0, iOut = 0, iLit = 0;
+	while (1) {
+		int mLen = 0, mDist = 0;
+		if ((iIn + slLZ_MIN) <= Len) {					// find match via hash of next 3 bytes
+			u32_t Key = pIn[iIn] | (pIn[iIn + 1] << 8) | (pIn[iIn + 2] << 16);
+			int Hash = (u32_t) (Key * 2654435761UL) >> 24;
+			int Cand = LzHash[Hash];
+			LzHash[Hash] = iIn;
+			if (Cand != 0xFFFF && memcmp(&pIn[Cand], &pIn[iIn], slLZ_MIN) == 0) {
+				mDist = iIn - Cand;
+				mLen = slLZ_MIN;
+				while (mLen < slLZ_MAX && (iIn + mLen) < Len && pIn[Cand + mLen] == pIn[iIn + mLen])
+					++mLen;
+			}
+		}
+		int nLit = iIn - iLit;
+		if (nLit && (mLen || nLit == slLZ_LITS || iIn == Len)) {	// emit pending literals
+			if ((iOut + 1 + nLit) >= Len)
+				return 0;
+			pOut[iOut++] = nLit - 1;
+			memcpy(&pOut[iOut], &pIn[iLit], nLit);
+			iOut += nLit;
+			iLit = iIn;
+		}
+		if (iIn == Len)
+			break;
+		if (mLen) {
+			if ((iOut + 2) >= Len)
+				return 0;
+			pOut[iOut++] = 0x80 | ((mLen - slLZ_MIN) << 2) | ((mDist - 1) >> 8);
+			pOut[iOut++] = (mDist - 1) & 0xFF;
+			iIn += mLen;
+			iLit = iIn;
+		} else {
+			++iIn;
+		}
+	}
+	return iOut;
+}
+
+/**
+ * @brief	decompress a block produced by xSyslogLzPack()
+ * @return	erSUCCESS if exactly Raw bytes produced, else erFAILURE (corrupt block)
+ */
+static int xSyslogLzUnpack(const u8_t * pIn, int Len, u8_t * pOut, int Raw) {
+	int iIn = 0, iOut = 0;
+	while (iIn < Len) {
+		u8_t Ctl = pIn[iIn++];
+		if (Ctl & 0x80) {
+			if (iIn == Len)
+				return erFAILURE;
+			int mLen = ((Ctl >> 2) & 0x1F) + slLZ_MIN;
+			int mDist = (((Ctl & 0x03) << 8) | pIn[iIn++]) + 1;
+			if (mDist > iOut || (iOut + mLen) > Raw)
+				return erFAILURE;
+			for (int i = 0; i < mLen; ++i, ++iOut)		// byte by byte, source may overlap
+				pOut[iOut] = pOut[iOut - mDist];
+		} else {
+			int nLit = Ctl + 1;
+			if ((iIn + nLit) > Len || (iOut + nLit) > Raw)
+				return erFAILURE;
+			memcpy(&pOut[iOut], &pIn[iIn], nLit);
+			iIn += nLit;
+			iOut += nLit;
+		}
+	}
+	return (iOut == Raw) ? erSUCCESS : erFAILURE;
+}
+
+/**
+ * @brief	read & decompress the block at Ofs in a segment
+ * @return	size of block in file with *pxRaw set to length of its records, 0 if end of segment or invalid,
+ * 			erFAILURE if read error, block may still be valid
+ * @note	caller must hold shSLfile & shLFSmux
+ */
+static int xSyslogBlockLoad(const char * pcName, u32_t Ofs, u8_t * pRaw, int * pxRaw) {
+	FILE * fp = fopen(pcName, "rb");
+	if (fp == NULL)
+		return (errno == ENOENT) ? 0 : erFAILURE;		// no segment, else file system error
+	sl_fblk_t sBlk;
+	int Size = 0;
+	if (fseek(fp, Ofs, SEEK_SET) == 0 && fread(&sBlk, sizeof(sBlk), 1, fp) == 1 &&
+		sBlk.raw && sBlk.raw <= slSTORE_BUF && sBlk.packed < sBlk.raw) {
+		if (sBlk.packed == 0) {							// stored raw
+			if (fread(pRaw, 1, sBlk.raw, fp) == sBlk.raw)
+				Size = sBlk.raw;
+		} else if (fread(LzBuf, 1, sBlk.packed, fp) == sBlk.packed &&
+			xSyslogLzUnpack(LzBuf, sBlk.packed, pRaw, sBlk.raw) == erSUCCESS) {
+			Size = sBlk.packed;
+		}
+	}
+	if (Size == 0 && ferror(fp))						// failed reading, not end of file or invalid
+		Size = erFAILURE;
+	fclose(fp);
+	if (Size <= 0)
+		return Size;
+	*pxRaw = sBlk.raw;
+	return sizeof(sBlk) + Size;
+}
+
+/**
+ * @brief	compress records into a block, write it to current segment, advance/evict segments as required
+ * @return	1 if written else 0, records then kept by caller & written later
+ * @note	caller must hold shSLfile, shLFSmux is taken here
+ */
+static bool vSyslogStoreWrite(const u8_t * pU8, int Len) {
+	sl_fblk_t sBlk = { .raw = Len, .packed = xSyslogLzPack(pU8, Len, &LzBuf[sizeof(sl_fblk_t)]) };
+	if (sBlk.packed == 0)								// incompressible, store as is
+		memcpy(&LzBuf[sizeof(sl_fblk_t)], pU8, Len);
+	memcpy(LzBuf, &sBlk, sizeof(sl_fblk_t));
+	Len = sizeof(sl_fblk_t) + (sBlk.packed ? sBlk.packed : Len);
+	if (xRtosSemaphoreTake(&shLFSmux, slMS_LOCK_WAIT) == pdFALSE)
+		return 0;
+	char caName[24];
+	if (wrSize && (wrSize + Len) > slSEG_SIZE) {		// current segment full?
+		++sCur.wrSeq;									// yes, move to next segment
+		wrSize = 0;
+		if ((sCur.wrSeq - sCur.rdSeq) >= slSEG_COUNT) {	// ring full?
+			vSyslogStoreUnlink(sCur.rdSeq);				// yes, evict oldest segment
+			++sCur.rdSeq;
+			sCur.rdOfs = sCur.rdRec = 0;
+			slSTAT_INC(StoreEvict);
+		}
+		vSyslogStoreUnlink(sCur.wrSeq);					// discard any stale content
+		vSyslogStoreSaveCursor();
+	}
+	vSyslogStoreName(caName, sCur.wrSeq);
+	FILE * fp = fopen(caName, "ab");
+	if (fp == NULL) {									// nothing written, keep records
+		slSTAT_INC(StoreErrs);
+		xRtosSemaphoreGive(&shLFSmux);
+		return 0;
+	}
+	int Wr = fwrite(LzBuf, 1, Len, fp);
+	if (fclose(fp) != 0)
+		Wr = 0;
+	if (Wr != Len) {									// partial block, later blocks unreadable behind it
+		slSTAT_INC(StoreErrs);
+		if (truncate(caName, wrSize) != 0)				// cut back to last complete block
+			wrSize = slSEG_SIZE;						// failed, next block starts a new segment
+		xRtosSemaphoreGive(&shLFSmux);
+		return 0;
+	}
+	sl_fidx_t sIdx;										// index entry only once block complete
+	vSyslogIndexBuild(pU8, sBlk.raw, wrSize, &sIdx);
+	vSyslogIndexName(caName, sCur.wrSeq);
+	if ((fp = fopen(caName, "ab")) != NULL) {
+		fwrite(&sIdx, sizeof(sIdx), 1, fp);
+		fclose(fp);
+	}
+	wrSize += Wr;
+	slSTAT_ADD(StoreRaw, sBlk.raw);
+	slSTAT_ADD(StorePacked, Len);
+	FileBuffer = 1;
+	xRtosSemaphoreGive(&shLFSmux);
+	return 1;
+}
+
+/**
+ * @brief	write buffered records to current segment
+ * @note	caller must hold shSLfile
+ */
+static void vSyslogStoreFlush(void) {
+	if (StoreLen && vSyslogStoreWrite(StoreBuf, StoreLen))
+		StoreLen = 0;
+}
+#endif
+
+/**
+ * @brief	encode a host message as an offline record, PRI & UTC as binary fields, hostname excluded
+ * @param[in]	pcTail & xTail header remainder and body following the hostname
+ * @return	size of record, tail truncated to fit Size
+ */
+static int IRAM_ATTR xSyslogRecEncode(u8_t * pU8, int Size, int Pri, u64_t Utc, const char * pcTail, int xTail) {
+	sl_frec_t sRec = { .len = xTail, .pri = Pri, .sec = Utc / 1000000ULL, .msec = (Utc / 1000ULL) % 1000 };
+	if (sRec.len > (Size - sizeof(sl_frec_t)))			// bigger than buffer?
+		sRec.len = Size - sizeof(sl_frec_t);			// yes, truncate
+	memcpy(pU8, &sRec, sizeof(sl_frec_t));
+	memcpy(pU8 + sizeof(sl_frec_t), pcTail, sRec.len);
+	return sizeof(sl_frec_t) + sRec.len;
+}
+
+/**
+ * @brief	render an offline record as a host message, PRE rebuilt from binary fields & hostname bound now
+ * @param[out]	psRec record header, *pxPre offset of hostname in pcBuf
+ * @return	length of message in pcBuf (slSIZEBUF), 0 if record invalid
+ */
+static int IRAM_ATTR xSyslogRecRender(const u8_t * pU8, int Avail, sl_frec_t * psRec, char * pcBuf, int * pxPre) {
+	if (Avail < (int) sizeof(sl_frec_t))
+		return 0;
+	memcpy(psRec, pU8, sizeof(sl_frec_t));
+	if ((int) (sizeof(sl_frec_t) + psRec->len) > Avail)
+		return 0;
+	int xPre = xSyslogHostPre(pcBuf, psRec->pri, slFREC_UTC(psRec));
+	int xName = xSyslogHostNameGet(pcBuf + xPre);		// xPre + slFRAG_LEN always fits
+	if ((xPre + xName + psRec->len) > slSIZEBUF)
+		return 0;
+	memcpy(pcBuf + xPre + xName, pU8 + sizeof(sl_frec_t), psRec->len);
+	*pxPre = xPre;
+	return xPre + xName + psRec->len;
+}
+
+#if (appLITTLEFS == 1)
+
+/**
+ * @brief	buffer a host message as a record, excluding PRE header (binary) & hostname
+ * @param[in]	xHost offset & xName length of the hostname in pcMsg
+ */
+static void vSyslogStoreAppend(const char * pcMsg, int xLen, int xHost, int xName, int Pri, u64_t Utc) {
+	int xTail = xLen - xHost - xName;
+	int Len = (sizeof(sl_frec_t) + xTail > slSTORE_BUF) ? slSTORE_BUF : (sizeof(sl_frec_t) + xTail);
+	xRtosSemaphoreTake(&shSLfile, portMAX_DELAY);
+	if ((StoreLen + Len) > slSTORE_BUF)
+		vSyslogStoreFlush();							// make space
+	if ((StoreLen + Len) > slSTORE_BUF) {				// flush failed, LFS busy?
+		xRtosSemaphoreGive(&shSLfile);
+		return;											// yes, message lost
+	}
+	if (StoreLen == 0)
+		StoreTime = xTaskGetTickCount();
+	StoreLen += xSyslogRecEncode(&StoreBuf[StoreLen], slSTORE_BUF - StoreLen, Pri, Utc, pcMsg + xHost + xName, xTail);
+	FileBuffer = 1;
+	slSTAT_INC(SinkMsgs[slSINK_FILE]);
+	slSTAT_ADD(SinkBytes[slSINK_FILE], Len - sizeof(sl_frec_t));
+	xRtosSemaphoreGive(&shSLfile);
+}
+
+/**
+ * @brief	append encoded records to the store after buffered records, written as full blocks
+ */
+static void vSyslogStoreBulk(const u8_t * pU8, int Len) {
+	xRtosSemaphoreTake(&shSLfile, portMAX_DELAY);
+	for (int Ofs = 0; Ofs < Len; ) {
+		sl_frec_t sRec;
+		memcpy(&sRec, pU8 + Ofs, sizeof(sRec));
+		int Size = sizeof(sRec) + sRec.len;
+		if ((StoreLen + Size) > slSTORE_BUF)
+			vSyslogStoreFlush();						// block full, write it
+		if ((StoreLen + Size) > slSTORE_BUF)			// flush failed, LFS busy?
+			break;										// yes, remaining records lost
+		if (StoreLen == 0)
+			StoreTime = xTaskGetTickCount();
+		memcpy(&StoreBuf[StoreLen], pU8 + Ofs, Size);
+		StoreLen += Size;
+		Ofs += Size;
+		slSTAT_INC(SinkMsgs[slSINK_FILE]);
+		slSTAT_ADD(SinkBytes[slSINK_FILE], sRec.len);
+	}
+	vSyslogStoreFlush();
+	xRtosSemaphoreGive(&shSLfile);
+}
+
+/**
+ * @brief	flush buffered records if older than slMS_STORE_FLUSH
+ */
+static void vSyslogStoreTick(void) {
+	if (StoreLen && (xTaskGetTickCount() - StoreTime) >= pdMS_TO_TICKS(slMS_STORE_FLUSH))
+		vSyslogFileFlush();
+}
+#endif
+
+/**
+ * @brief	accumulate host send result, demote/restore effective host level at end of window
+ * @note	caller must hold shSLsock
+ */
+static void IRAM_ATTR vSyslogGovernor(bool bOK, u32_t Latency) {
+	++GovSends;
+	GovFails += bOK ? 0 : 1;
+	GovLatency += Latency;
+	u64_t Now = halTIMER_ReadRunTime();
+	if ((Now - GovTime) < (slMS_GOV_WINDOW * 1000ULL))
+		return;
+	if (GovFails >= slGOV_FAILS || (GovLatency / GovSends) > slGOV_LATENCY) {
+		if (GovDemote < SL_SEV_DEBUG) {
+			++GovDemote;								// tripped, reduce host volume
+			GovChange = Now;
+		}
+		slSTAT_INC(GovTrips);
+	} else if (GovDemote && (Now - GovChange) >= (slMS_GOV_RESTORE * 1000ULL)) {
+		--GovDemote;									// clean for long enough, restore 1 level
+		GovChange = Now;
+	}
+	GovTime = Now;
+	GovSends = GovFails = 0;
+	GovLatency = 0;
+}
+
+/**
+ * @brief	host level after governor demotion, never demoted below SL_SEV_ERROR
+ */
+static int IRAM_ATTR xSyslogHostLevelEffective(int Level) {
+	if (GovDemote == 0 || Level <= SL_SEV_ERROR)
+		return Level;
+	Level -= GovDemote;
+	return (Level < SL_SEV_ERROR) ? SL_SEV_ERROR : Level;
+}
+
+/**
+ * @brief	check message against the host's level, following the host level (& governor) if not set
+ * @return	1 if message to be sent to the host
+ */
+static bool IRAM_ATTR bSyslogHostWants(sl_host_t * psH, sl_vars_t * psV) {
+	int Sev = psV->pri & 7;
+	if (psH->level != slLEV_FOLLOW)
+		return (Sev <= psH->level);
+	if (Sev > psV->hlev)								// filter based on higher priorities
+		return 0;
+	if (psH->role == slROLE_FAILOVER && Sev > xSyslogHostLevelEffective(psV->hlev)) {
+		slSTAT_INC(GovDrops);							// throttled by governor
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief	first host of the failover group, in registry order, that is (or can be) connected
+ * @return	pointer to host, NULL if none connected
+ * @note	hosts in BACKOFF cost a single atomic load, once expired the preferred host is retried first
+ */
+static sl_host_t * IRAM_ATTR psSyslogActive(void) {
+	for (int i = 0; i < slHOSTS; ++i) {
+		if (sHost[i].role != slROLE_FAILOVER || xSyslogConnect(&sHost[i]) == 0)
+			continue;
+		if (__atomic_exchange_n(&HostActive, i, __ATOMIC_RELAXED) != i)
+			slSTAT_INC(Failovers);						// failed over, or back
+		return &sHost[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief	move batched (live) messages to the offline store and empty the batch
+ * @note	caller must hold shSLsock but NOT shSLfile, replayed messages are still in the store
+ * @note	only the failover group is backed by the store, copies are dropped
+ */
+static void vSyslogBatchSpill(sl_host_t * psH) {
+	if (psH->role == slROLE_COPY)
+		psH->drops += psH->bcount;
+	#if (appLITTLEFS == 1)
+	for (int i = 0; psH->role == slROLE_FAILOVER && i < psH->bcount && halEventCheckDevice(devMASK_LFS); ++i) {
+		sl_bmsg_t * psM = &psH->bmsg[i];
+		if (psM->spill)
+			vSyslogStoreAppend(&psH->batch[psM->ofs], psM->len, psM->host, psM->name, psM->pri, psM->utc);
+	}
+	#endif
+	psH->blen = psH->bcount = 0;
+}
+
+/**
+ * @brief	send all batched messages in a single write
+ * @return	erSUCCESS, or erFAILURE if send failed (connection closed, live messages spilled)
+ * @note	caller must hold shSLsock, batch is empty on return
+ */
+static int IRAM_ATTR xSyslogBatchFlush(sl_host_t * psH) {
+	if (psH->bcount == 0)
+		return erSUCCESS;
+	bool bOK = 0;
+	if (psH->state == slCON_UP) {
+		u64_t tSend = halTIMER_ReadRunTime();
+		int iRV = xNetSend(&psH->sCtx, (u8_t *) psH->batch, psH->blen);
+		tSend = halTIMER_ReadRunTime() - tSend;
+		bOK = (iRV == psH->blen);						// partial stream write also a failure
+		slSTAT_INC(Sends);
+		if (psH->role == slROLE_FAILOVER)				// a dead copy never throttles the group
+			vSyslogGovernor(bOK, tSend);
+		vSyslogHist(sStats.SendHist, tSend);
+		if (bOK) {
+			psH->sCtx.maxTx = (iRV > psH->sCtx.maxTx) ? iRV : psH->sCtx.maxTx;
+			psH->sent += psH->bcount;
+		} else {
+			++psH->fails;
+			slSTAT_INC(SendFails);
+			xNetClose(&psH->sCtx);
+			vSyslogBackoff(psH);
+		}
+	}
+	if (bOK == 0) {
+		vSyslogBatchSpill(psH);
+		return erFAILURE;
+	}
+	for (int i = 0; i < psH->bcount; ++i) {
+		int Sink = psH->bmsg[i].replay ? slSINK_REPLAY : slSINK_HOST;
+		slSTAT_INC(SinkMsgs[Sink]);
+		slSTAT_ADD(SinkBytes[Sink], psH->bmsg[i].len);
+	}
+	psH->blen = psH->bcount = 0;
+	return erSUCCESS;
+}
+
+static bool IRAM_ATTR bSyslogBatchFits(sl_host_t * psH, int xLen) {
+	if (psH->bcount == 0)
+		return 1;										// a single message always fits
+	if (Transport == slXPORT_UDP)
+		return (UdpBatch > 0) && (psH->bcount < slBATCH_MSGS) && ((psH->blen + 1 + xLen) <= UdpBatch);
+	return (psH->bcount < slBATCH_MSGS) && ((psH->blen + slFRAME_MAX + xLen) <= slBATCH_SIZE);
+}
+
+/**
+ * @brief	append a message to the batch, framed as required by the transport
+ * @param[in]	xHost offset & xName length of hostname in pcMsg, bSpill if not replayed & header complete
+ * @param[in]	Pri & Utc of the message, kept for the offline store if spilled
+ * @return	erSUCCESS, or erFAILURE if the batch could not be flushed to make space
+ * @note	caller must hold shSLsock
+ */
+static int IRAM_ATTR xSyslogBatchAdd(sl_host_t * psH, const char * pcMsg, int xLen, int xHost, int xName, bool bSpill, bool bReplay,
+		int Pri, u64_t Utc) {
+	if (bSyslogBatchFits(psH, xLen) == 0 && xSyslogBatchFlush(psH) < erSUCCESS)
+		return erFAILURE;
+	if (psH->bcount == 0)
+		psH->btime = halTIMER_ReadRunTime();
+	if (Transport != slXPORT_UDP)						// RFC6587 octet counting
+		psH->blen += snprintf(&psH->batch[psH->blen], slFRAME_MAX, "%d ", xLen);
+	else if (psH->bcount)								// UDP batch, LF separated
+		psH->batch[psH->blen++] = CHR_LF;
+	psH->bmsg[psH->bcount++] = (sl_bmsg_t) { .ofs = psH->blen, .len = xLen, .host = xHost, .name = xName,
+		.spill = bSpill, .replay = bReplay, .pri = Pri, .utc = Utc };
+	memcpy(&psH->batch[psH->blen], pcMsg, xLen);
+	psH->blen += xLen;
+	return erSUCCESS;
+}
+
+/**
+ * @brief	check if the batch must be sent now, only the syslog task holds messages back
+ * @param[in]	Sev severity of the message just added
+ */
+static bool IRAM_ATTR bSyslogBatchDue(sl_host_t * psH, int Sev) {
+	if ((Transport == slXPORT_UDP && UdpBatch == 0) || Sev <= SL_SEV_ERROR || psH->bcount == slBATCH_MSGS)
+		return 1;
+	#if (slASYNC > 0)
+	return (hSLtask == NULL) || (xTaskGetCurrentTaskHandle() != hSLtask);
+	#else
+	return 1;
+	#endif
+}
+
+/**
+ * @brief	check if any host holds batched messages
+ */
+static bool IRAM_ATTR bSyslogBatchHeld(void) {
+	for (int i = 0; i < slHOSTS; ++i) {
+		if (sHost[i].bcount)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief	send each host's batch once its oldest message is older than slMS_BATCH_FLUSH
+ */
+static void vSyslogBatchTick(u64_t Now) {
+	if (bSyslogBatchHeld() == 0 || xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE)
+		return;
+	for (int i = 0; i < slHOSTS; ++i) {
+		sl_host_t * psH = &sHost[i];
+		if (psH->bcount && (Now - psH->btime) >= (slMS_BATCH_FLUSH * 1000ULL))
+			xSyslogBatchFlush(psH);
+	}
+	xRtosSemaphoreGive(&shSLsock);
+}
+
+/**
+ * @brief	send pending batch, close connection & return host to DOWN without backoff
+ * @note	caller must hold shSLnet & shSLsock, a claimed (CONNECTING) attempt waits for shSLnet & is left as is
+ */
+static void vSyslogHostReset(sl_host_t * psH) {
+	xSyslogBatchFlush(psH);
+	if (psH->state == slCON_UP)
+		xNetClose(&psH->sCtx);
+	psH->backoff = psH->retries = 0;
+	if (psH->state != slCON_CONNECTING)
+		__atomic_store_n(&psH->state, slCON_DOWN, __ATOMIC_RELEASE);
+}
+
+#if (slSTAGE_SIZE > 0)
+/**
+ * @brief	end boot staging, sending staged records to psH if connected (and no older backlog) else storing them
+ * @note	caller must hold shSLsock but NOT shSLfile
+ */
+static void vSyslogStageRelease(sl_host_t * psH) {
+	bool bSend = psH && (psH->state == slCON_UP);
+	#if (appLITTLEFS == 1)
+	bSend = bSend && (FileBuffer == 0);					// keep order behind offline backlog
+	if (bSend == 0 && StageLen && halEventCheckDevice(devMASK_LFS)) {
+		vSyslogStoreBulk(StageBuf, StageLen);			// full blocks, not 1 write per message
+		StageLen = StageCount = 0;
+	}
+	#endif
+	char * pcBuf = bSend ? pcSyslogScratchClaim() : NULL;
+	if (bSend && pcBuf == NULL)
+		return;											// stay open, retry next tick
+	for (int Ofs = 0; pcBuf && Ofs < StageLen; ) {		// bind hostname now, batch & send
+		sl_frec_t sRec;
+		int xPre, xLen = xSyslogRecRender(&StageBuf[Ofs], StageLen - Ofs, &sRec, pcBuf, &xPre);
+		if (xLen)
+			xSyslogBatchAdd(psH, pcBuf, xLen, xPre, xLen - xPre - sRec.len, 1, 0, sRec.pri, slFREC_UTC(&sRec));
+		Ofs += sizeof(sRec) + sRec.len;
+	}
+	if (pcBuf) {
+		xSyslogBatchFlush(psH);							// failure spills to offline store
+		vSyslogScratchFree(pcBuf);
+	}
+	if (bSend == 0 && StageLen)							// not connected & no store?
+		slSTAT_ADD(StageDrops, StageCount);
+	StageLen = StageCount = 0;
+	StageOpen = 0;
+}
+
+/**
+ * @brief	hold a host message in the boot staging buffer
+ * @return	1 if staged else 0, message to be handled normally
+ * @note	caller must hold shSLsock
+ */
+static bool IRAM_ATTR bSyslogStageAppend(sl_host_t * psH, const char * pcMsg, int xLen, int xHost, int xName, int Pri, u64_t Utc) {
+	int xTail = xLen - xHost - xName;
+	int Len = sizeof(sl_frec_t) + xTail;
+	if ((StageLen + Len) > slSTAGE_SIZE) {				// full?
+		#if (appLITTLEFS == 1)
+		if (halEventCheckDevice(devMASK_LFS)) {			// yes, store all & stop staging
+			vSyslogStageRelease(psH);
+			return 0;
+		}
+		#endif
+		slSTAT_INC(StageDrops);							// no store, keep oldest boot messages
+		return 1;
+	}
+	StageLen += xSyslogRecEncode(&StageBuf[StageLen], slSTAGE_SIZE - StageLen, Pri, Utc, pcMsg + xHost + xName, xTail);
+	++StageCount;
+	slSTAT_INC(Staged);
+	return 1;
+}
+
+/**
+ * @brief	release staged messages once connected, or to the store once slMS_STAGE_HOLD expired
+ */
+static void vSyslogStageTick(u64_t Now) {
+	if (StageOpen == 0)
+		return;
+	sl_host_t * psH = psSyslogActive();
+	#if (appLITTLEFS == 1)
+	bool bHold = (Now >= (slMS_STAGE_HOLD * 1000ULL)) && halEventCheckDevice(devMASK_LFS);
+	#else
+	bool bHold = 0;										// nowhere else to go, wait for connection
+	#endif
+	if ((psH || bHold) && xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdTRUE) {
+		if (StageOpen)
+			vSyslogStageRelease(psH);
+		xRtosSemaphoreGive(&shSLsock);
+	}
+}
+#endif
+
+/**
+ * @brief	per host, BACKOFF -> DOWN once expired, UP -> DOWN if L3 lost
+ */
+static void vSyslogConnectTick(u64_t Now) {
+	for (int i = 0; i < slHOSTS; ++i) {
+		sl_host_t * psH = &sHost[i];
+		u8_t State = __atomic_load_n(&psH->state, __ATOMIC_ACQUIRE);
+		if (State == slCON_BACKOFF && Now >= psH->tNext) {
+			__atomic_compare_exchange_n(&psH->state, &State, slCON_DOWN, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+		} else if (State == slCON_UP && halEventCheckStatus(flagLX_STA) == 0) {
+			if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdTRUE) {
+				vSyslogBatchSpill(psH);					// batch cannot be sent, keep what we can
+				xNetClose(&psH->sCtx);
+				__atomic_store_n(&psH->state, slCON_DOWN, __ATOMIC_RELEASE);
+				xRtosSemaphoreGive(&shSLsock);
+			}
+		}
+	}
+}
+
+static void IRAM_ATTR vSyslogHost(sl_vars_t * psV, char * pcBody, int xLen) {
+	int xPre, xName, xHdr = xSyslogHostHeader(psV, pcBody - slHEADROOM, &xPre, &xName);
+	if (psV->sd && xHdr < slHEADROOM)					// body starts with SD-ELEMENT?
+		xHdr -= 2;										// yes, drop "- " NILVALUE at end of header
+	char * pcMsg = pcSyslogPrepend(pcBody, xHdr);
+	xLen = xSyslogRemoveTerminators(pcMsg, xLen + (pcBody - pcMsg));
+
+	// Failover group, first connected host in registry order, its level applies (entry 0 if none connected)
+	int iRV = erFAILURE;
+	bool bSpill = ((pcBody - pcMsg) == xHdr);			// only if header was not truncated
+	sl_host_t * psA = psSyslogActive();
+	if (bSyslogHostWants(psA ? psA : &sHost[0], psV)) {
+		// During boot, until first connection, hold message in RAM
+		bool bStaged = 0;
+		#if (slSTAGE_SIZE > 0)
+		if (StageOpen && bSpill && xRtosSemaphoreTake(&shSLsock, pdMS_TO_TICKS(slMS_LOCK_WAIT)) == pdTRUE) {
+			bStaged = StageOpen && bSyslogStageAppend(psA, pcMsg, xLen, xPre, xName, psV->pri, psV->utc);
+			xRtosSemaphoreGive(&shSLsock);
+		}
+		#endif
+		// If connected, take semaphore and if still ok, batch the message, send if due
+		if (bStaged == 0 && psA && xRtosSemaphoreTake(&shSLsock, pdMS_TO_TICKS(slMS_LOCK_WAIT)) == pdTRUE) {
+			if (psA->state == slCON_UP) {				// still connected once semaphore taken?
+				iRV = xSyslogBatchAdd(psA, pcMsg, xLen, xPre, xName, bSpill, 0, psV->pri, psV->utc);
+				if (iRV == erSUCCESS && bSyslogBatchDue(psA, psV->pri & 7))
+					xSyslogBatchFlush(psA);				// failure spills batch, this message included
+			}
+			xRtosSemaphoreGive(&shSLsock);
+		}
+		#if (appLITTLEFS == 1)	/* HOST not accessible try send to LFS if available ***********/
+		if (bStaged == 0 && iRV < erSUCCESS && halEventCheckDevice(devMASK_LFS) && bSpill)
+			vSyslogStoreAppend(pcMsg, xLen, xPre, xName, psV->pri, psV->utc);
+		#endif
+	}
+
+	// Copies, same rendered message, each with own level, connection & batch, dropped while down
+	for (int i = 0; i < slHOSTS; ++i) {
+		sl_host_t * psH = &sHost[i];
+		if (psH->role != slROLE_COPY || bSyslogHostWants(psH, psV) == 0)
+			continue;
+		iRV = erFAILURE;
+		if (xSyslogConnect(psH) && xRtosSemaphoreTake(&shSLsock, pdMS_TO_TICKS(slMS_LOCK_WAIT)) == pdTRUE) {
+			if (psH->state == slCON_UP) {
+				iRV = xSyslogBatchAdd(psH, pcMsg, xLen, xPre, xName, 0, 0, psV->pri, psV->utc);
+				if (iRV == erSUCCESS && bSyslogBatchDue(psH, psV->pri & 7))
+					xSyslogBatchFlush(psH);
+			}
+			xRtosSemaphoreGive(&shSLsock);
+		}
+		if (iRV < erSUCCESS)
+			__atomic_fetch_add(&psH->drops, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * @brief	deliver a rendered body to the console and (filtered) host sinks
+ * @note	pcBody must have slHEADROOM bytes available ahead and slTAILROOM after the body
+ */
+static void IRAM_ATTR vSyslogDeliver(sl_vars_t * psV, char * pcBody, int xLen) {
+	vSyslogConsole(psV, pcBody, xLen);
+	if ((psV->pri & 7) > psV->hlev && (psV->pri & 7) > HostLevelMax)
+		return;											// no host wants it, each host filters again
+	vSyslogHost(psV, pcBody, xLen);
+}
+
+/**
+ * @brief	parse a single conversion specification
+ * @param[in]	pcSpec pointer to the '%' starting the specification
+ * @param[out]	pType argument class consumed by the conversion, slARG_BAD if not capturable
+ * @return	pointer to the conversion character
+ */
+static const char * IRAM_ATTR pcSyslogSpec(const char * pcSpec, u8_t * pType) {
+	const char * pc = pcSpec + 1;
+	while (*pc && strchr("-+ #0!'", *pc))				// flags, including printfx '!'
+		++pc;
+	while (isdigit((int) *pc) || *pc == '.')			// width & precision, '*' not supported
+		++pc;
+	int Size = sizeof(int), nLong = 0;
+	bool bLongDbl = 0;
+	while (*pc && strchr("hlLqjzt", *pc)) {				// length modifiers
+		if (*pc == 'l')			Size = (++nLong == 1) ? sizeof(long) : sizeof(long long);
+		else if (*pc == 'z')	Size = sizeof(size_t);
+		else if (*pc == 't')	Size = sizeof(ptrdiff_t);
+		else if (*pc == 'L')	bLongDbl = 1;
+		else if (*pc != 'h')	Size = sizeof(long long);
+		++pc;
+	}
+	switch (*pc) {
+	case '%':	*pType = slARG_NONE;	break;
+	case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c': case 'C':
+				*pType = (Size > (int) sizeof(u32_t)) ? slARG_I64 : slARG_I32;	break;
+	case 'R':	*pType = slARG_I64;		break;			// printfx time value is always u64_t
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+				*pType = bLongDbl ? slARG_BAD : slARG_DBL;	break;
+	case 'p':	*pType = slARG_PTR;		break;
+	case 's':	*pType = slARG_STR;		break;
+	default:	*pType = slARG_BAD;		break;			// '*', %n, unknown/custom conversions
+	}
+	if ((pc - pcSpec + 1) >= slMAX_SPEC)
+		*pType = slARG_BAD;
+	return pc;
+}
+
+/**
+ * @brief	capture the raw argument words described by format
+ * @return	erSUCCESS if all arguments captured, erFAILURE if format must be rendered by caller
+ * @note	vaList is copied, caller's va_list remains usable
+ */
+static int IRAM_ATTR xSyslogCapture(sl_args_t * psA, const char * format, va_list vaList) {
+	if (format == NULL)
+		return erFAILURE;
+	int iRV = erSUCCESS;
+	va_list vaCopy;
+	va_copy(vaCopy, vaList);
+	psA->count = 0;
+	for (const char * pc = strchr(format, '%'); pc; pc = strchr(pc + 1, '%')) {
+		u8_t Type;
+		pc = pcSyslogSpec(pc, &Type);
+		if (Type == slARG_NONE)
+			continue;
+		if (Type == slARG_BAD || psA->count == slMAX_ARGS) {
+			iRV = erFAILURE;
+			break;
+		}
+		sl_arg_t * psArg = &psA->arg[psA->count];
+		psArg->u64 = 0;									// unused upper bytes hashed by signature
+		switch (Type) {
+		case slARG_I32:	psArg->u32 = va_arg(vaCopy, unsigned int);	break;
+		case slARG_I64:	psArg->u64 = va_arg(vaCopy, u64_t);			break;
+		case slARG_DBL:	psArg->f64 = va_arg(vaCopy, double);		break;
+		default:		psArg->ptr = va_arg(vaCopy, const void *);	break;
+		}
+		psA->type[psA->count++] = Type;
+	}
+	va_end(vaCopy);
+	return iRV;
+}
+
+/**
+ * @brief	signature of a captured message, raw argument words (and %s contents) hashed onto call site hash
+ */
+static u32_t IRAM_ATTR xSyslogSignature(u32_t Hash, sl_args_t * psA) {
+	for (int i = 0; i < psA->count; ++i) {
+		if (psA->type[i] == slARG_STR)
+			Hash = psA->arg[i].ptr ? xSyslogHash(Hash, psA->arg[i].ptr, strlen(psA->arg[i].ptr)) : Hash;
+		else
+			Hash = xSyslogHash(Hash, &psA->arg[i], sizeof(sl_arg_t));
+	}
+	return Hash;
+}
+
+/**
+ * @brief	encode key/value pairs in binary form, key pointer, type & value (strings copied)
+ * @return	number of bytes used, pairs that do not fit Size are dropped whole
+ */
+static int IRAM_ATTR xSyslogKVEncode(u8_t * pU8, int Size, const sl_kv_t * psKV, int Count) {
+	int Used = 0;
+	for (int i = 0; i < Count; ++i, ++psKV) {
+		int xVal = (psKV->type == slKV_STR) ? (psKV->str ? strlen(psKV->str) : 0) + 1 :
+				   (psKV->type <= slKV_U32 || psKV->type == slKV_BOOL) ? sizeof(u32_t) : sizeof(u64_t);
+		if ((Used + sizeof(char *) + 1 + xVal) > Size)
+			continue;									// a shorter pair may still fit
+		memcpy(&pU8[Used], &psKV->key, sizeof(char *));
+		Used += sizeof(char *);
+		pU8[Used++] = psKV->type;
+		if (psKV->type == slKV_STR) {
+			memcpy(&pU8[Used], psKV->str ? psKV->str : "", xVal);
+		} else if (xVal == sizeof(u32_t)) {
+			memcpy(&pU8[Used], &psKV->u32, xVal);
+		} else {
+			memcpy(&pU8[Used], &psKV->u64, xVal);
+		}
+		Used += xVal;
+	}
+	return Used;
+}
+
+/**
+ * @brief	render encoded key/value pairs as an SD-ELEMENT, '"' '\' & ']' in PARAM-VALUEs escaped
+ * @return	length rendered, pairs that do not fit Size-1 are dropped whole
+ */
+static int IRAM_ATTR xSyslogKVRender(char * pcBuf, int Size, const char * SdID, const u8_t * pU8, int xKV) {
+	int xLen = strlen(SdID);
+	if ((xLen + 3) > Size)
+		return 0;
+	pcBuf[0] = '[';
+	memcpy(pcBuf + 1, SdID, xLen);
+	xLen += 1;
+	for (int Ofs = 0; Ofs < xKV; ) {
+		const char * pcKey;
+		memcpy(&pcKey, &pU8[Ofs], sizeof(char *));
+		u8_t Type = pU8[Ofs + sizeof(char *)];
+		Ofs += sizeof(char *) + 1;
+		char caVal[24];
+		const char * pcVal = caVal;
+		int xVal = 0, xEsc = 0;
+		u32_t U32;
+		u64_t U64;
+		if (Type == slKV_STR) {
+			pcVal = (const char *) &pU8[Ofs];
+			xVal = strlen(pcVal);
+			Ofs += xVal + 1;
+			for (int i = 0; i < xVal; ++i)
+				xEsc += (pcVal[i] == '"' || pcVal[i] == '\\' || pcVal[i] == ']') ? 1 : 0;
+		} else if (Type <= slKV_U32 || Type == slKV_BOOL) {
+			memcpy(&U32, &pU8[Ofs], sizeof(u32_t));
+			Ofs += sizeof(u32_t);
+			if (Type == slKV_BOOL) {
+				pcVal = U32 ? "true" : "false";
+				xVal = strlen(pcVal);
+			} else if (Type == slKV_I32 && (i32_t) U32 < 0) {
+				caVal[0] = '-';
+				xVal = 1 + xSyslogU64toA(&caVal[1], -(i64_t) (i32_t) U32);
+			} else {
+				xVal = xSyslogU64toA(caVal, U32);
+			}
+		} else {
+			memcpy(&U64, &pU8[Ofs], sizeof(u64_t));
+			Ofs += sizeof(u64_t);
+			if (Type == slKV_DBL) {
+				double F64;
+				memcpy(&F64, &U64, sizeof(double));
+				xVal = snprintf(caVal, sizeof(caVal), "%.7g", F64);
+			} else if (Type == slKV_I64 && (i64_t) U64 < 0) {
+				caVal[0] = '-';
+				xVal = 1 + xSyslogU64toA(&caVal[1], -(u64_t) U64);
+			} else {
+				xVal = xSyslogU64toA(caVal, U64);
+			}
+		}
+		int xKey = strlen(pcKey);
+		if ((xLen + 1 + xKey + 2 + xVal + xEsc + 1 + 1) >= Size)
+			continue;									// SP key=" value " & closing ']'
+		pcBuf[xLen++] = ' ';
+		memcpy(&pcBuf[xLen], pcKey, xKey);
+		xLen += xKey;
+		pcBuf[xLen++] = '=';
+		pcBuf[xLen++] = '"';
+		for (int i = 0; i < xVal; ++i) {
+			if (pcVal[i] == '"' || pcVal[i] == '\\' || pcVal[i] == ']')
+				pcBuf[xLen++] = '\\';
+			pcBuf[xLen++] = pcVal[i];
+		}
+		pcBuf[xLen++] = '"';
+	}
+	pcBuf[xLen++] = ']';
+	pcBuf[xLen] = CHR_NUL;
+	return xLen;
+}
+
+#if (slASYNC > 0)
+/* Bounded MPMC ring (D. Vyukov) where each slot's sequence number arbitrates ownership:
+ * seq == pos				slot free for the producer claiming position pos
+ * seq == pos + 1			slot committed, available to be taken by consumer at position pos
+ * seq == pos + SLOTS		slot released, free for the producer one lap later
+ * The syslog task is the only regular consumer, producers only take when evicting (slOVF_DROP_OLD or
+ * shedding a lower severity lane). One ring per severity lane, each with its own size.
+ */
+static sl_slot_t * IRAM_ATTR psSyslogRingClaim(sl_lane_t * psL, u32_t * pPos) {
+	u32_t Pos = __atomic_load_n(&psL->head, __ATOMIC_RELAXED);
+	while (1) {
+		sl_slot_t * psS = &psL->slot[Pos & psL->mask];
+		i32_t Dif = (i32_t) (__atomic_load_n(&psS->seq, __ATOMIC_ACQUIRE) - Pos);
+		if (Dif == 0) {
+			if (__atomic_compare_exchange_n(&psL->head, &Pos, Pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				*pPos = Pos;
+				return psS;
+			}											// CAS failed, Pos reloaded, try again
+		} else if (Dif < 0) {
+			return NULL;								// full
+		} else {
+			Pos = __atomic_load_n(&psL->head, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/**
+ * @brief	take the oldest committed slot, only if its severity is numerically greater than Above
+ * @param[in]	Above -1 to take any severity, else incoming severity when shedding
+ * @return	pointer to slot taken, NULL if empty, oldest not yet committed or not of lower severity
+ */
+static sl_slot_t * IRAM_ATTR psSyslogRingTake(sl_lane_t * psL, u32_t * pPos, int Above) {
+	u32_t Pos = __atomic_load_n(&psL->tail, __ATOMIC_RELAXED);
+	while (1) {
+		sl_slot_t * psS = &psL->slot[Pos & psL->mask];
+		i32_t Dif = (i32_t) (__atomic_load_n(&psS->seq, __ATOMIC_ACQUIRE) - (Pos + 1));
+		if (Dif == 0) {
+			if ((int) (psS->sV.pri & 7) <= Above)		// committed, pri stable until tail moves
+				return NULL;
+			if (__atomic_compare_exchange_n(&psL->tail, &Pos, Pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				*pPos = Pos;
+				return psS;
+			}
+		} else if (Dif < 0) {
+			return NULL;								// empty
+		} else {
+			Pos = __atomic_load_n(&psL->tail, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+#define vSyslogRingCommit(psS, Pos)			__atomic_store_n(&(psS)->seq, (Pos) + 1, __ATOMIC_RELEASE)
+#define vSyslogRingRelease(psL, psS, Pos)	__atomic_store_n(&(psS)->seq, (Pos) + (psL)->mask + 1, __ATOMIC_RELEASE)
+
+/**
+ * @brief	messages queued in all lanes, approximate while producers are active
+ */
+static u32_t IRAM_ATTR xSyslogRingDepth(void) {
+	u32_t Depth = 0;
+	for (int l = 0; l < slLANES; ++l)
+		Depth += __atomic_load_n(&sLane[l].head, __ATOMIC_RELAXED) - __atomic_load_n(&sLane[l].tail, __ATOMIC_RELAXED);
+	return Depth;
+}
+
+/**
+ * @brief	take the next message for delivery, strict priority or weighted round robin across lanes
+ * @return	pointer to slot taken, *ppsL set to its lane, NULL if all lanes empty
+ */
+static sl_slot_t * psSyslogLaneNext(sl_lane_t ** ppsL, u32_t * pPos) {
+	for (int Round = 0; Round < 2; ++Round) {
+		for (int l = 0; l < slLANES; ++l) {
+			if (LaneSched == slSCHED_WEIGHTED && LaneCredit[l] == 0)
+				continue;								// lane had its share this round
+			sl_slot_t * psS = psSyslogRingTake(&sLane[l], pPos, -1);
+			if (psS) {
+				LaneCredit[l] -= (LaneSched == slSCHED_WEIGHTED) ? 1 : 0;
+				*ppsL = &sLane[l];
+				return psS;
+			}
+		}
+		if (LaneSched != slSCHED_WEIGHTED)
+			break;
+		memcpy(LaneCredit, LaneWeight, sizeof(LaneCredit));	// lanes with credit empty, next round
+	}
+	return NULL;
+}
+
+#if (slDEFERRED > 0)
+/**
+ * @brief	render a captured message, one conversion specification at a time
+ * @return	number of characters rendered
+ */
+static int xSyslogRender(report_t * psR, const char * format, sl_args_t * psA) {
+	int xLen = 0, Idx = 0;
+	char Spec[slMAX_SPEC];
+	const char * pc = format;
+	while (*pc) {
+		const char * pcSpec = strchr(pc, '%');
+		if (pcSpec == NULL) {
+			xLen += xReport(psR, "%s", pc);
+			break;
+		}
+		if (pcSpec > pc)
+			xLen += xReport(psR, "%.*s", (int) (pcSpec - pc), pc);
+		u8_t Type;
+		pc = pcSyslogSpec(pcSpec, &Type) + 1;
+		if (Type == slARG_NONE) {
+			xLen += xReport(psR, "%%");
+			continue;
+		}
+		memcpy(Spec, pcSpec, pc - pcSpec);
+		Spec[pc - pcSpec] = CHR_NUL;
+		if (Idx >= psA->count || Type != psA->type[Idx])
+			break;										// format does not match captured arguments
+		sl_arg_t * psArg = &psA->arg[Idx++];
+		switch (Type) {
+		case slARG_I32:	xLen += xReport(psR, Spec, psArg->u32);	break;
+		case slARG_I64:	xLen += xReport(psR, Spec, psArg->u64);	break;
+		case slARG_DBL:	xLen += xReport(psR, Spec, psArg->f64);	break;
+		default:		xLen += xReport(psR, Spec, psArg->ptr);	break;
+		}
+	}
+	return xLen;
+}
+#endif
+
+/**
+ * @brief	overwrite the end of a truncated body or string with slTRUNC_MARK & count it
+ * @param[in]	pcEnd one past the last byte kept, Len bytes kept
+ */
+static void IRAM_ATTR vSyslogTruncMark(char * pcEnd, int Len) {
+	int Mark = (Len < (int) sizeof(slTRUNC_MARK) - 1) ? Len : (int) sizeof(slTRUNC_MARK) - 1;
+	memcpy(pcEnd - Mark, slTRUNC_MARK, Mark);
+	slSTAT_INC(Truncated);
+}
+
+#if (slDEFERRED > 0)
+/**
+ * @brief	copy-on-capture all %s arguments into a string pool, truncating (marked) to fit, and repoint them
+ * @return	number of pool bytes used
+ */
+static int IRAM_ATTR xSyslogArgsCopy(sl_args_t * psA, char * pcPool, int Size) {
+	int Used = 0;
+	for (int i = 0; i < psA->count; ++i) {
+		if (psA->type[i] != slARG_STR || psA->arg[i].ptr == NULL)
+			continue;
+		int Len = strlen(psA->arg[i].ptr), Room = Size - 1 - Used;
+		bool bCut = (Len > Room);						// pool full?
+		if (bCut)
+			Len = Room;									// yes, truncate to fit, even to ""
+		memcpy(&pcPool[Used], psA->arg[i].ptr, Len);
+		pcPool[Used + Len] = CHR_NUL;
+		if (bCut)
+			vSyslogTruncMark(&pcPool[Used + Len], Len);
+		psA->arg[i].ptr = &pcPool[Used];
+		Used = (Len < Room) ? (Used + Len + 1) : (Size - 1);	// once full, later strings share last terminator
+	}
+	return Used;
+}
+#endif
+
+/**
+ * @brief	claim a slot in the lane, if full spill into lower severity lanes shedding their oldest
+ * @param[in]	Sev severity of the incoming message, only a strictly lower severity (greater value) is shed
+ * @return	pointer to claimed slot, NULL if own & all lower lanes full and no oldest slot of lower severity
+ * @note	lower lanes may hold spilled messages of the incoming (or higher) severity, these are never shed
+ */
+static sl_slot_t * IRAM_ATTR psSyslogLaneClaim(int Lane, int Sev, u32_t * pPos) {
+	sl_slot_t * psS;
+	for (int l = Lane; l < slLANES; ++l) {				// own lane, else lower lane with space
+		if ((psS = psSyslogRingClaim(&sLane[l], pPos)) != NULL)
+			return psS;
+	}
+	for (int l = slLANES - 1; l > Lane; --l) {			// lowest severity shed first
+		u32_t PosOld;
+		sl_slot_t * psOld = psSyslogRingTake(&sLane[l], &PosOld, Sev);
+		if (psOld == NULL)
+			continue;
+		vSyslogRingRelease(&sLane[l], psOld, PosOld);
+		slSTAT_INC(RingDrops);
+		slSTAT_INC(LaneShed);
+		if ((psS = psSyslogRingClaim(&sLane[l], pPos)) != NULL)
+			return psS;
+	}
+	return NULL;
+}
+
+/**
+ * @brief	claim a ring slot, applying the overflow policy if the lane (and those below) is full
+ * @return	pointer to claimed slot, NULL if message must be dropped
+ */
+static sl_slot_t * IRAM_ATTR psSyslogRingClaimPolicy(int Pri, u32_t * pPos, bool bTask) {
+	sl_slot_t * psS;
+	int Lane = slLANE(Pri);
+	while ((psS = psSyslogLaneClaim(Lane, Pri & 7, pPos)) == NULL) {
+		int Policy = RingPolicy;
+		if (Policy == slOVF_DROP_OLD) {
+			u32_t PosOld;
+			sl_slot_t * psOld = psSyslogRingTake(&sLane[Lane], &PosOld, -1);
+			if (psOld == NULL) {						// oldest not yet committed (producer preempted)
+				slSTAT_INC(RingDrops);					// never spin waiting for it, drop new instead
+				return NULL;
+			}
+			vSyslogRingRelease(&sLane[Lane], psOld, PosOld);	// discard oldest, retry claim
+			slSTAT_INC(RingDrops);
+		} else if (Policy == slOVF_BLOCK && bTask) {
+			xTaskNotifyGive(hSLtask);					// ensure syslog task is draining
+			vTaskDelay(1);
+		} else {
+			slSTAT_INC(RingDrops);
+			return NULL;
+		}
+	}
+	return psS;
+}
+
+static void IRAM_ATTR vSyslogRingNotify(bool bTask) {
+	if (bTask) {
+		xTaskNotifyGive(hSLtask);
+	} else if (xPortInIsrContext()) {
+		BaseType_t bWoken = pdFALSE;
+		vTaskNotifyGiveFromISR(hSLtask, &bWoken);
+		portYIELD_FROM_ISR(bWoken);
+	}
+}
+
+static int IRAM_ATTR xSyslogPostBody(sl_vars_t * psV, const char * pcBody, int xLen) {
+	u32_t Pos;
+	bool bTask = (xPortInIsrContext() == 0) && (xTaskGetCurrentTaskHandle() != hSLtask);
+	sl_slot_t * psS = psSyslogRingClaimPolicy(psV->pri, &Pos, bTask);
+	if (psS == NULL)
+		return erFAILURE;
+	psS->sV = *psV;
+	#if (slDEFERRED > 0)
+	psS->fmt = NULL;
+	#endif
+	psS->sdid = NULL;
+	psS->len = (xLen < slRING_BODY) ? xLen : slRING_BODY;
+	if (psS->len)
+		memcpy(psS->body, pcBody, psS->len);
+	if (xLen > slRING_BODY)								// only if slRING_BODY < slBODYSIZE
+		vSyslogTruncMark(&psS->body[slRING_BODY], slRING_BODY);
+	vSyslogRingCommit(psS, Pos);
+	vSyslogRingNotify(bTask);
+	return erSUCCESS;
+}
+
+/**
+ * @brief	claim a ring slot, copy encoded key/value pairs into it and wake the syslog task
+ * @return	erSUCCESS if posted, erFAILURE if dropped
+ */
+static int IRAM_ATTR xSyslogPostKV(sl_vars_t * psV, const char * SdID, const u8_t * pKV, int xKV) {
+	u32_t Pos;
+	bool bTask = (xPortInIsrContext() == 0) && (xTaskGetCurrentTaskHandle() != hSLtask);
+	sl_slot_t * psS = psSyslogRingClaimPolicy(psV->pri, &Pos, bTask);
+	if (psS == NULL)
+		return erFAILURE;
+	psS->sV = *psV;
+	#if (slDEFERRED > 0)
+	psS->fmt = NULL;
+	#endif
+	psS->sdid = SdID;
+	psS->len = xKV;										// encoded to fit slRING_BODY
+	memcpy(psS->body, pKV, xKV);
+	vSyslogRingCommit(psS, Pos);
+	vSyslogRingNotify(bTask);
+	return erSUCCESS;
+}
+
+#if (slDEFERRED > 0)
+/**
+ * @brief	claim a ring slot, copy captured arguments (and %s strings) into it and wake the syslog task
+ * @return	erSUCCESS if posted, erFAILURE if dropped
+ */
+static int IRAM_ATTR xSyslogPostArgs(sl_vars_t * psV, const char * format, sl_args_t * psA) {
+	u32_t Pos;
+	bool bTask = (xPortInIsrContext() == 0) && (xTaskGetCurrentTaskHandle() != hSLtask);
+	sl_slot_t * psS = psSyslogRingClaimPolicy(psV->pri, &Pos, bTask);
+	if (psS == NULL)
+		return erFAILURE;
+	psS->sV = *psV;
+	psS->fmt = format;
+	psS->sdid = NULL;
+	psS->sA = *psA;
+	psS->len = xSyslogArgsCopy(&psS->sA, psS->body, slRING_BODY);
+	vSyslogRingCommit(psS, Pos);
+	vSyslogRingNotify(bTask);
+	return erSUCCESS;
+}
+#endif
+#endif
+
+/**
+ * @brief	find module override for function
+ * @return	override level, -1 if none
+ */
+static int IRAM_ATTR xSyslogModuleLevel(const char * FuncID) {
+	for (int i = 0; i < ModuleCount; ++i) {
+		if (strncmp(FuncID, sModule[i].name, sModule[i].len) == 0)
+			return sModule[i].level;
+	}
+	return -1;
+}
+
+/**
+ * @brief	rebuild the SLlevels snapshot from options/local levels and module overrides
+ */
+static void vSyslogLevelsRefresh(void) {
+	int Con = xSyslogGetConsoleLevel(), Host = xSyslogGetHostLevel(), Gate = Con;
+	for (int i = 0; i < ModuleCount; ++i)
+		Gate = (sModule[i].level > Gate) ? sModule[i].level : Gate;
+	#if (slTRACE > 0)
+	Gate = (TraceLevel > Gate) ? TraceLevel : Gate;
+	#endif
+	__atomic_store_n(&SLlevels, slLEVELS(Gate, Con, Host), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief	take a token (GCRA) from the bucket owned by Key, (re)claiming the bucket if owned by another key
+ * @return	1 if conforming (or Rate is 0) else 0
+ * @note	colliding keys share the arrival time, alternating keys cannot refill the bucket by reclaiming it
+ */
+static bool IRAM_ATTR bSyslogRateTake(sl_bucket_t * psTable, const void * Key, u32_t Rate, u32_t Burst, u32_t Now) {
+	if (Rate == 0)
+		return 1;
+	sl_bucket_t * psB = &psTable[xSyslogHash(2166136261UL, &Key, sizeof(Key)) & (slRATE_KEYS - 1)];
+	const void * Owner = __atomic_load_n(&psB->key, __ATOMIC_ACQUIRE);
+	if (Owner != Key && __atomic_compare_exchange_n(&psB->key, &Owner, Key, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		__atomic_store_n(&psB->drops, 0, __ATOMIC_RELAXED);	// new key, or collision, drops reported per owner
+	u32_t Interval = 1000000UL / Rate, Limit = (Burst - 1) * Interval;
+	u32_t Tat = __atomic_load_n(&psB->tat, __ATOMIC_RELAXED);
+	while (1) {
+		u32_t Ahead = Tat - Now;						// how far TAT is in the future
+		if (Ahead > Limit + Interval)					// in the past (wrapped), bucket full
+			Ahead = 0;
+		if (Ahead > Limit) {
+			__atomic_fetch_add(&psB->drops, 1, __ATOMIC_RELAXED);
+			return 0;
+		}
+		if (__atomic_compare_exchange_n(&psB->tat, &Tat, Now + Ahead + Interval, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return 1;
+	}
+}
+
+/**
+ * @brief	check message against PRI & FuncID rate limits
+ * @return	1 if message may proceed else 0
+ */
+static bool IRAM_ATTR bSyslogRateCheck(sl_vars_t * psV) {
+	if ((psV->pri & 7) <= slRATE_EXEMPT)
+		return 1;
+	u32_t Now = (u32_t) psV->run;
+	bool bOK = bSyslogRateTake(sRatePri, (const void *) (uintptr_t) psV->pri, RatePri, slRATE_PRI_BURST, Now) &&
+			   bSyslogRateTake(sRateFunc, psV->func, RateFunc, slRATE_FUNC_BURST, Now);
+	if (bOK == 0)
+		slSTAT_INC(RateDrops);
+	return bOK;
+}
+
+/**
+ * @brief	check signature against recent messages, count if repeat else record in LRU/free entry
+ * @param[out]	psEvict summary required if psEvict->sV.count non-zero, entry evicted or count saturated
+ * @return	1 if repeat (suppress) else 0
+ * @note	lock free, entry ownership & count changes only by CAS on the packed key word
+ */
+static bool IRAM_ATTR bSyslogDedup(sl_vars_t * psV, sl_dedup_t * psEvict) {
+	u32_t Sig = slDEDUP_SIG(psV->crc ^ (psV->pri * 0x9E3779B1UL));
+	Sig = Sig ? Sig : 0x100;							// 0 reserved for free entries
+	psEvict->sV.count = 0;
+	for (int Try = 0; Try < 2; ++Try) {
+		sl_dedup_t * psLRU = NULL;
+		u32_t KeyLRU = 0;
+		for (int i = 0; i < slDEDUP_SIZE; ++i) {
+			sl_dedup_t * psE = &sDedup[i];
+			u32_t Key = __atomic_load_n(&psE->key, __ATOMIC_ACQUIRE);
+			while (Key && slDEDUP_SIG(Key) == Sig) {	// repeat, count it
+				bool bFull = (slDEDUP_CNT(Key) == 0xFF);
+				if (__atomic_compare_exchange_n(&psE->key, &Key, bFull ? (Sig | 1) : (Key + 1), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+					if (bFull) {						// count saturated, summarise & start new window
+						*psEvict = *psE;
+						psEvict->sV.count = 0xFF;
+						psE->first = psV->run;
+					}
+					psE->sV = *psV;						// current message info now basis of next repeat
+					slSTAT_INC(Deduped);
+					return 1;
+				}
+			}
+			if (psLRU == NULL || (KeyLRU && (Key == 0 || psE->sV.run < psLRU->sV.run))) {
+				psLRU = psE;							// free, or least recently used
+				KeyLRU = Key;
+			}
+		}
+		sl_dedup_t sCopy = *psLRU;
+		if (__atomic_compare_exchange_n(&psLRU->key, &KeyLRU, Sig, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			if (slDEDUP_CNT(KeyLRU)) {					// evicted entry had repeats?
+				*psEvict = sCopy;						// yes, summarise before it is lost
+				psEvict->sV.count = slDEDUP_CNT(KeyLRU);
+			}
+			psLRU->first = psV->run;
+			psLRU->sV = *psV;
+			return 0;
+		}
+	}
+	return 0;											// contended, deliver without recording
+}
+
+/**
+ * @brief	emit "Repeated Nx in T ms" summary for a dedup entry
+ */
+static void IRAM_ATTR vSyslogRepeated(sl_dedup_t * psE) {
+	char caBuf[slHEADROOM + 40 + slTAILROOM];
+	char * pcBody = &caBuf[slHEADROOM];
+	int xLen = xSyslogBody(pcBody, 40, formatREPEATED, psE->sV.count, (unsigned long) ((psE->sV.run - psE->first) / 1000));
+	#if (slASYNC > 0)
+	TaskHandle_t hTask = __atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE);
+	if (hTask && hTask != xTaskGetCurrentTaskHandle()) {
+		xSyslogPostBody(&psE->sV, pcBody, xLen);
+		return;
+	}
+	#endif
+	vSyslogDeliver(&psE->sV, pcBody, xLen);
+}
+
+/**
+ * @brief	summarise entries with repeats older than slMS_DEDUP_WINDOW and free idle entries
+ */
+static void vSyslogDedupFlush(u64_t Now) {
+	sl_dedup_t sOut[slDEDUP_SIZE];
+	int Count = 0;
+	for (int i = 0; i < slDEDUP_SIZE; ++i) {
+		sl_dedup_t * psE = &sDedup[i];
+		u32_t Key = __atomic_load_n(&psE->key, __ATOMIC_ACQUIRE);
+		if (Key == 0)
+			continue;
+		if (slDEDUP_CNT(Key) && (Now - psE->first) >= (slMS_DEDUP_WINDOW * 1000ULL)) {
+			sOut[Count] = *psE;
+			if (__atomic_compare_exchange_n(&psE->key, &Key, slDEDUP_SIG(Key), 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+				sOut[Count++].sV.count = slDEDUP_CNT(Key);	// summary required
+				psE->first = Now;						// start new window, keep suppressing
+			}
+		} else if (slDEDUP_CNT(Key) == 0 && (Now - psE->sV.run) >= (slMS_DEDUP_WINDOW * 1000ULL)) {
+			__atomic_compare_exchange_n(&psE->key, &Key, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);	// idle, free
+		}
+	}
+	for (int i = 0; i < Count; ++i)
+		vSyslogRepeated(&sOut[i]);
+}
+
+#if (slMS_STATS_EMIT > 0)
+/**
+ * @brief	deliver the statistics counters as an RFC5424 SD-ELEMENT
+ */
+static void vSyslogStatsEmit(u64_t Now) {
+	if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		return;
+	char * pcBuf = pcSyslogScratchClaim();
+	if (pcBuf == NULL)
+		return;
+	sl_stats_t sS;
+	vSyslogGetStats(&sS);
+	sl_vars_t sV = { .pri = SL_PRI(SL_FAC_SYSLOG, SL_SEV_NOTICE), .sd = 1, .core = esp_cpu_get_core_id(),
+		.hlev = slLEV_HOST(__atomic_load_n(&SLlevels, __ATOMIC_RELAXED)), .run = Now, .utc = sTSZ.usecs,
+		.task = pcTaskGetName(NULL), .func = __FUNCTION__ };
+	char * pcBody = pcBuf + slHEADROOM;
+	int xLen = xSyslogBody(pcBody, slBODYSIZE, DRAM_STR("[" slSTATS_SDID " sev=\"%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\""
+		" filtered=\"%lu\" deduped=\"%lu\" dropped=\"%lu\" host=\"%lu/%lu\" file=\"%lu\" replay=\"%lu\""
+		" fails=\"%lu\" reconnects=\"%lu\" depth=\"%lu\"]"),
+		sS.Logged[0], sS.Logged[1], sS.Logged[2], sS.Logged[3], sS.Logged[4], sS.Logged[5], sS.Logged[6], sS.Logged[7],
+		sS.Filtered, sS.Deduped, sS.RateDrops + sS.ScratchDrops + sS.RingDrops + sS.GovDrops,
+		sS.SinkMsgs[slSINK_HOST], sS.SinkBytes[slSINK_HOST], sS.SinkMsgs[slSINK_FILE], sS.SinkMsgs[slSINK_REPLAY],
+		sS.SendFails, sS.Reconnects, sS.StoreDepth);
+	vSyslogDeliver(&sV, pcBody, xLen);
+	vSyslogScratchFree(pcBuf);
+}
+#endif
+
+#if (slTRACE > 0)
+/**
+ * @brief	validate flight recorder contents retained through reset, request dump if any
+ * @note	build stamp is the app ELF SHA-256, format, function & %s pointers retained from any other
+ * 			image (OTA or rebuild) are never used
+ */
+static void vSyslogTraceCheck(void) {
+	const esp_app_desc_t * psApp = esp_app_get_description();
+	u32_t Build = xSyslogHash(2166136261UL, psApp->app_elf_sha256, sizeof(psApp->app_elf_sha256));
+	if (sTrace.magic != slTRACE_MAGIC || sTrace.build != Build) {
+		memset(&sTrace, 0, sizeof(sTrace));
+		sTrace.magic = slTRACE_MAGIC;
+		sTrace.build = Build;
+	} else if (sTrace.head) {							// records from before reset
+		TraceDumped = sTrace.head - slTRACE_SLOTS;
+		TraceReq |= slTRACE_ALL;
+	}
+	TraceValid = 1;
+}
+
+/**
+ * @brief	record a message, captured arguments & %s strings copied, no rendering
+ * @return	record seq, passed to vSyslogTraceSent() once message sent to host
+ */
+static u32_t IRAM_ATTR xSyslogTraceRecord(int MsgPRI, const char * FuncID, const char * format, sl_args_t * psA) {
+	if (TraceValid == 0)
+		vSyslogTraceCheck();
+	u32_t Idx = __atomic_fetch_add(&sTrace.head, 1, __ATOMIC_RELAXED);
+	sl_trace_t * psT = &sTrace.sE[Idx & (slTRACE_SLOTS - 1)];
+	__atomic_store_n(&psT->seq, 0, __ATOMIC_RELAXED);	// invalid while being written
+	psT->utc = sTSZ.usecs;
+	psT->fmt = format;
+	psT->func = FuncID;
+	psT->pri = MsgPRI & 0xFF;
+	psT->core = esp_cpu_get_core_id();
+	psT->raw = (psA == NULL);
+	const char * pcTask = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? DRAM_STR("preX") : pcTaskGetName(NULL);
+	strncpy(psT->task, pcTask, sizeof(psT->task) - 1);
+	psT->task[sizeof(psT->task) - 1] = CHR_NUL;
+	if (psA) {
+		psT->sA = *psA;
+		xSyslogArgsCopy(&psT->sA, psT->str, slTRACE_STR);
+	}
+	__atomic_store_n(&psT->seq, Idx + 1, __ATOMIC_RELEASE);
+	return Idx + 1;
+}
+
+/**
+ * @brief	mark record as sent to host, not rendered again by a new records dump
+ * @note	stale seq of an overwritten record never matches the new record's seq
+ */
+static void IRAM_ATTR vSyslogTraceSent(u32_t Seq) {
+	if (Seq)
+		__atomic_store_n(&sTrace.sE[(Seq - 1) & (slTRACE_SLOTS - 1)].sent, Seq, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief	render recorded messages, oldest first, to the host sink
+ * @param[in]	bAll 1 to dump all records, 0 for records not already sent to the host since last dump
+ */
+static void vSyslogTraceRender(bool bAll) {
+	char * pcBuf = pcSyslogScratchClaim();
+	if (pcBuf == NULL) {
+		__atomic_fetch_or(&TraceReq, bAll ? slTRACE_ALL : slTRACE_NEW, __ATOMIC_RELAXED);	// retry later
+		return;
+	}
+	char * pcBody = pcBuf + slHEADROOM;
+	u32_t Head = __atomic_load_n(&sTrace.head, __ATOMIC_ACQUIRE);
+	u32_t Idx = ((Head - TraceDumped) > slTRACE_SLOTS) ? (Head - slTRACE_SLOTS) : TraceDumped;
+	for (; Idx != Head; ++Idx) {
+		sl_trace_t * psT = &sTrace.sE[Idx & (slTRACE_SLOTS - 1)];
+		if (__atomic_load_n(&psT->seq, __ATOMIC_ACQUIRE) != (Idx + 1) ||
+			(bAll == 0 && __atomic_load_n(&psT->sent, __ATOMIC_RELAXED) == (Idx + 1)))
+			continue;
+		sl_trace_t sT = *psT;
+		if (__atomic_load_n(&psT->seq, __ATOMIC_ACQUIRE) != (Idx + 1))
+			continue;									// overwritten while copied
+		for (int i = 0; i < sT.sA.count; ++i) {			// repoint %s arguments to copy
+			if (sT.raw == 0 && sT.sA.type[i] == slARG_STR && sT.sA.arg[i].ptr)
+				sT.sA.arg[i].ptr = sT.str + ((const char *) sT.sA.arg[i].ptr - psT->str);
+		}
+		report_t sRpt = { .pcAlloc = pcBody, .pcBuf = pcBody, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slBODYSIZE) };
+		int xLen = xReport(&sRpt, DRAM_STR("trace: "));
+		xLen += sT.raw ? xReport(&sRpt, "%s", sT.fmt) : xSyslogRender(&sRpt, sT.fmt, &sT.sA);
+		xLen = (xLen < slBODYSIZE) ? xLen : slBODYSIZE - 1;
+		sl_vars_t sV = { .pri = sT.pri, .core = sT.core, .hlev = SL_SEV_DEBUG, .run = halTIMER_ReadRunTime(),
+			.utc = sT.utc, .task = sT.task, .func = sT.func };
+		vSyslogHost(&sV, pcBody, xLen);
+	}
+	TraceDumped = Head;
+	vSyslogScratchFree(pcBuf);
+}
+
+/**
+ * @brief	render requested dump, if any
+ */
+static void vSyslogTraceService(void) {
+	u8_t Req = __atomic_exchange_n(&TraceReq, 0, __ATOMIC_ACQUIRE);
+	if (Req)
+		vSyslogTraceRender((Req & slTRACE_ALL) ? 1 : 0);
+}
+
+/**
+ * @brief	request a dump, rendered by the syslog task if running else immediately
+ */
+static void IRAM_ATTR vSyslogTraceRequest(u8_t Req) {
+	__atomic_fetch_or(&TraceReq, Req, __ATOMIC_RELAXED);
+	#if (slASYNC > 0)
+	TaskHandle_t hTask = __atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE);
+	if (hTask) {
+		if (xPortInIsrContext() == 0 && xTaskGetCurrentTaskHandle() != hTask)
+			xTaskNotifyGive(hTask);						// else picked up at next pass
+		return;
+	}
+	#endif
+	if (xPortInIsrContext() == 0)
+		vSyslogTraceService();
+}
+#endif
+
+/**
+ * @brief	periodic housekeeping, at most once per slMS_TASK_TICK
+ */
+static void vSyslogTick(void) {
+	u64_t Now = halTIMER_ReadRunTime();
+	if ((Now - TickTime) < (slMS_TASK_TICK * 1000ULL))
+		return;
+	TickTime = Now;
+	vSyslogLevelsRefresh();
+	vSyslogConnectTick(Now);
+	#if (slSTAGE_SIZE > 0)
+	vSyslogStageTick(Now);
+	#endif
+	vSyslogDedupFlush(Now);
+	#if (appLITTLEFS == 1)
+	vSyslogStoreTick();
+	#endif
+	#if (slMS_STATS_EMIT > 0)
+	if ((Now - StatsTime) >= (slMS_STATS_EMIT * 1000ULL)) {
+		StatsTime = Now;
+		vSyslogStatsEmit(Now);
+	}
+	#endif
+}
+
+#if (slASYNC > 0)
+static void vSyslogTask(void * pvPara) {
+	while (1) {
+		u32_t Wait = slMS_TASK_TICK;
+		#if (appLITTLEFS == 1)
+		Wait = FileBuffer ? slMS_REPLAY_TICK : Wait;
+		#endif
+		Wait = (bSyslogBatchHeld() && Wait > slMS_BATCH_FLUSH) ? slMS_BATCH_FLUSH : Wait;
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(Wait));
+		vSyslogTick();
+		#if (slTRACE > 0)
+		vSyslogTraceService();							// context ahead of the message that triggered it
+		#endif
+		u32_t Pos;
+		sl_slot_t * psS;
+		sl_lane_t * psL;
+		int Count = 0;									// bound live messages per pass, to interleave replay
+		while ((Count++ < slRING_TOTAL) && (psS = psSyslogLaneNext(&psL, &Pos)) != NULL) {
+			sl_vars_t sV = psS->sV;
+			char * pcBody = &SLrender[slHEADROOM];
+			int xLen;
+			if (psS->sdid) {							// encoded key/value pairs, render now
+				xLen = xSyslogKVRender(pcBody, slBODYSIZE, psS->sdid, (u8_t *) psS->body, psS->len);
+			} else
+			#if (slDEFERRED > 0)
+			if (psS->fmt) {								// captured arguments, render now
+				report_t sRpt = { .pcAlloc = pcBody, .pcBuf = pcBody, .Size = repSIZE_SET(sBUFFER,sgrNONE,0,0,slBODYSIZE) };
+				xLen = xSyslogRender(&sRpt, psS->fmt, &psS->sA);
+				xLen = (xLen < slBODYSIZE) ? xLen : slBODYSIZE - 1;
+			} else
+			#endif
+			{
+				xLen = psS->len;
+				memcpy(pcBody, psS->body, xLen);
+			}
+			vSyslogRingRelease(psL, psS, Pos);			// slot contents no longer required
+			vSyslogDeliver(&sV, pcBody, xLen);
+			if ((sV.pri & 7) <= SL_SEV_ERROR)
+				vSyslogHist(sStats.UrgentHist, halTIMER_ReadRunTime() - sV.run);
+		}
+		vSyslogBatchTick(halTIMER_ReadRunTime());
+		#if (appLITTLEFS == 1)
+		vSyslogFileSend();								// one budgeted replay pass
+		#endif
+		if (xSyslogRingDepth())							// live messages still queued?
+			xTaskNotifyGive(xTaskGetCurrentTaskHandle());	// yes, don't wait for next tick
+
+	}
+}
+
+/**
+ * @brief	(re)connect registry hosts that are DOWN, requested by xSyslogConnect() or every slMS_TASK_TICK
+ * @note	blocking name resolution & TCP/TLS handshakes happen here, senders only see UP hosts
+ */
+static void vSyslogNetTask(void * pvPara) {
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(slMS_TASK_TICK));
+		for (int i = 0; i < slHOSTS; ++i) {
+			if (__atomic_load_n(&sHost[i].role, __ATOMIC_ACQUIRE) != slROLE_OFF)
+				xSyslogConnect(&sHost[i]);				// UP or BACKOFF a single atomic load
+		}
+	}
+}
+#endif
+
+// ###################################### Public functions #########################################
+
+void vSyslogSetRateLimit(int PerPri, int PerFunc) {
+	RatePri = (PerPri > 0) ? PerPri : 0;
+	RateFunc = (PerFunc > 0) ? PerFunc : 0;
+}
+
+void vSyslogSetHostFormat(int Format) {
+	if (Format >= slFMT_PAPERTRAIL && Format <= slFMT_RFC5424)
+		HostFormat = Format;
+}
+
+void vSyslogSetConsoleFormat(int Format) {
+	if (Format >= slFMT_CON_ANSI && Format <= slFMT_CON_COMPACT)
+		ConsoleFormat = Format;
+}
+
+void vSyslogInit(void) {
+	vSyslogLevelsRefresh();
+	#if (slTRACE > 0)
+	if (TraceValid == 0)
+		vSyslogTraceCheck();
+	#endif
+	#if (slCON_BUF > 0)
+	if (hSLcon == NULL) {
+		TaskHandle_t hCon = NULL;
+		if (xTaskCreatePinnedToCore(vSyslogConTask, "slCon", slCON_STACK, NULL, slCON_PRIO, &hCon, tskNO_AFFINITY) == pdPASS)
+			__atomic_store_n(&hSLcon, hCon, __ATOMIC_RELEASE);	// from here on lines are buffered
+	}
+	#endif
+#if (slASYNC > 0)
+	if (hSLtask)
+		return;
+	for (int l = 0; l < slLANES; ++l) {
+		for (int i = 0; i <= sLane[l].mask; ++i)
+			sLane[l].slot[i].seq = i;
+		sLane[l].head = sLane[l].tail = 0;
+	}
+	memcpy(LaneCredit, LaneWeight, sizeof(LaneCredit));
+	TaskHandle_t hNet = NULL, hTask = NULL;
+	if (xTaskCreatePinnedToCore(vSyslogNetTask, "slNet", slNET_STACK, NULL, slNET_PRIO, &hNet, tskNO_AFFINITY) == pdPASS)
+		__atomic_store_n(&hSLnet, hNet, __ATOMIC_RELEASE);	// from here on connections made by slNet only
+	if (xTaskCreatePinnedToCore(vSyslogTask, "syslog", slTASK_STACK, NULL, slTASK_PRIO, &hTask, tskNO_AFFINITY) == pdPASS)
+		__atomic_store_n(&hSLtask, hTask, __ATOMIC_RELEASE);	// from here on messages are posted
+#endif
+}
+
+void vSyslogSetOverflow(int Policy) {
+#if (slASYNC > 0)
+	if (Policy >= slOVF_DROP_NEW && Policy <= slOVF_BLOCK)
+		RingPolicy = Policy;
+#endif
+}
+
+void vSyslogSetLaneSched(int Sched) {
+#if (slASYNC > 0)
+	if (Sched >= slSCHED_STRICT && Sched <= slSCHED_WEIGHTED)
+		LaneSched = Sched;
+#endif
+}
+
+u32_t xSyslogGetDropped(void) {
+#if (slASYNC > 0)
+	return __atomic_load_n(&sStats.RingDrops, __ATOMIC_RELAXED);
+#else
+	return 0;
+#endif
+}
+
+void vSyslogGetStats(sl_stats_t * psStats) {
+	const u32_t * pSrc = (const u32_t *) &sStats;
+	u32_t * pDst = (u32_t *) psStats;
+	for (int i = 0; i < (int) (sizeof(sl_stats_t) / sizeof(u32_t)); ++i)
+		pDst[i] = __atomic_load_n(&pSrc[i], __ATOMIC_RELAXED);
+	#if (appLITTLEFS == 1)
+	psStats->StoreDepth = StoreLen + ((sCur.wrSeq - sCur.rdSeq) * slSEG_SIZE) + wrSize - sCur.rdOfs;
+	#endif
+}
+
+int xSyslogSetTransport(int Xport, void * pvSec) {
+	if (Xport < slXPORT_UDP || Xport > slXPORT_TLS || (Xport == slXPORT_TLS && pvSec == NULL))
+		return erFAILURE;
+	if (xRtosSemaphoreTake(&shSLnet, slMS_LOCK_WAIT) == pdFALSE)	// lock order shSLnet -> shSLsock
+		return erFAILURE;
+	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE) {
+		xRtosSemaphoreGive(&shSLnet);
+		return erFAILURE;
+	}
+	for (int i = 0; i < slHOSTS; ++i)
+		vSyslogHostReset(&sHost[i]);					// pending messages sent with current framing
+	Transport = Xport;
+	pvSecure = pvSec;
+	xRtosSemaphoreGive(&shSLsock);
+	xRtosSemaphoreGive(&shSLnet);
+	return erSUCCESS;
+}
+
+int xSyslogSetHost(int Idx, const char * pcName, int Port, int Role, int Level) {
+	if (Idx < 1 || Idx >= slHOSTS || Role < slROLE_OFF || Role > slROLE_COPY || Level > SL_SEV_DEBUG ||
+		(Role != slROLE_OFF && (pcName == NULL || strlen(pcName) >= slHOST_NAME)))
+		return erFAILURE;
+	if (xRtosSemaphoreTake(&shSLnet, slMS_LOCK_WAIT) == pdFALSE)	// lock order shSLnet -> shSLsock
+		return erFAILURE;
+	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE) {
+		xRtosSemaphoreGive(&shSLnet);
+		return erFAILURE;
+	}
+	sl_host_t * psH = &sHost[Idx];
+	vSyslogHostReset(psH);
+	psH->role = slROLE_OFF;								// skipped while changed
+	if (Role != slROLE_OFF) {
+		strcpy(psH->caName, pcName);
+		psH->pName = psH->caName;
+		psH->tResolve = 0;								// resolve new name on next connection
+		psH->port = Port;
+		psH->level = (Level < 0) ? slLEV_FOLLOW : Level;
+		psH->sent = psH->fails = psH->drops = 0;
+		__atomic_store_n(&psH->role, Role, __ATOMIC_RELEASE);
+	}
+	int Max = -1;
+	for (int i = 0; i < slHOSTS; ++i) {
+		if (sHost[i].role != slROLE_OFF && sHost[i].level != slLEV_FOLLOW && sHost[i].level > Max)
+			Max = sHost[i].level;
+	}
+	HostLevelMax = Max;
+	xRtosSemaphoreGive(&shSLsock);
+	xRtosSemaphoreGive(&shSLnet);
+	return erSUCCESS;
+}
+
+void vSyslogSetUdpBatch(int Size) {
+	Size = (Size < 0) ? 0 : (Size > slBATCH_SIZE) ? slBATCH_SIZE : Size;
+	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE)
+		return;
+	for (int i = 0; i < slHOSTS; ++i)
+		xSyslogBatchFlush(&sHost[i]);					// pending messages sent with current packing
+	UdpBatch = Size;
+	xRtosSemaphoreGive(&shSLsock);
+}
+
+void vSyslogSetTraceLevel(int Level) {
+#if (slTRACE > 0)
+	TraceLevel = (Level < 0) ? 0 : (Level > SL_LEV_MAX) ? SL_LEV_MAX : Level;
+	vSyslogLevelsRefresh();
+#endif
+}
+
+void vSyslogTraceDump(void) {
+#if (slTRACE > 0)
+	if (TraceValid)
+		vSyslogTraceRequest(slTRACE_ALL);
+#endif
+}
+
+int xSyslogCheckDuplicates(int sock, struct sockaddr_in * addr) {
+	// Check for same port but socket not that of any registry host
+	bool bPort = 0;
+	for (int i = 0; i < slHOSTS; ++i) {
+		if (sHost[i].role == slROLE_OFF)
+			continue;
+		if (sock == sHost[i].sCtx.sd)
+			return 0;
+		bPort = bPort || (htons(addr->sin_port) == sHost[i].sCtx.sa_in.sin_port);
+	}
+	if (bPort) {
+		close(sock);
+		return 1;
+	}
+	return 0;
+}
+
+int xSyslogGetConsoleLevel(void) {
+#if (appOPTIONS > 0)
+	int iRV = xOptionGet(ioSLOGhi);
+	return iRV ? iRV : SL_LEV_CONSOLE;
+#else
+	return consoleLevel;
+#endif
+}
+
+int xSyslogGetHostLevel(void) {
+#if (appOPTIONS > 0)
+	int iRV = xOptionGet(ioSLhost);
+	return iRV ? iRV : SL_LEV_HOST;
+#else
+	return hostLevel;
+#endif
+}
+
+void vSyslogSetConsoleLevel(int Level) {
+	if (Level > SL_LEV_MAX)
+		Level = SL_LEV_MAX;
+#if (appOPTIONS > 0)
+	vOptionSet(ioSLOGhi, Level);
+#else
+	consoleLevel = Level;
+#endif
+	vSyslogLevelsRefresh();
+}
+
+// In the case where the log level is set to DEBUG in ESP-IDF the volume of messages being generated
+// could flood the IP stack and cause watchdog timeouts. Even if the timeout is changed from 5 to 10
+// seconds the crash can still occur. In order to minimise load on the IP stack the minimum severity
+// level should be set to NOTICE.
+
+void vSyslogSetHostLevel(int Level) {
+	if (Level > SL_LEV_MAX)
+		Level = SL_LEV_MAX;
+#if (appOPTIONS > 0)
+	vOptionSet(ioSLhost, Level);
+#else
+	hostLevel = Level;
+#endif
+	vSyslogLevelsRefresh();
+}
+
+int xSyslogSetModuleLevel(const char * pcName, int Level) {
+	int Len = pcName ? strlen(pcName) : 0;
+	if (Len == 0 || Len >= slMODULE_LEN)
+		return erFAILURE;
+	int Idx = 0;
+	while (Idx < ModuleCount && strcmp(sModule[Idx].name, pcName) != 0)
+		++Idx;
+	if (Level < 0) {									// remove override
+		if (Idx == ModuleCount)
+			return erFAILURE;
+		sModule[Idx] = sModule[ModuleCount - 1];		// move last entry into vacated slot
+		--ModuleCount;
+	} else {											// add/update override
+		if (Idx == slMODULE_MAX)
+			return erFAILURE;
+		sModule[Idx].level = (Level > SL_LEV_MAX) ? SL_LEV_MAX : Level;
+		if (Idx == ModuleCount) {
+			strcpy(sModule[Idx].name, pcName);
+			sModule[Idx].len = Len;
+			++ModuleCount;								// publish only once complete
+		}
+	}
+	vSyslogLevelsRefresh();
+	return erSUCCESS;
+}
+
+int xSyslogConfigModule(const char * pcCmd) {
+	const char * pcEq = pcCmd ? strchr(pcCmd, '=') : NULL;
+	if (pcEq == NULL || (pcEq - pcCmd) >= slMODULE_LEN)
+		return erFAILURE;
+	char caName[slMODULE_LEN];
+	memcpy(caName, pcCmd, pcEq - pcCmd);
+	caName[pcEq - pcCmd] = CHR_NUL;
+	char * pcEnd;
+	long Level = strtol(pcEq + 1, &pcEnd, 10);
+	if (pcEnd == pcEq + 1)
+		return erFAILURE;
+	return xSyslogSetModuleLevel(caName, Level);
+}
+
+#if (appLITTLEFS == 1)
+/**
+ * @brief	refill replay token bucket, burst limited to 1 second worth or 1 max size record
+ */
+static void vSyslogReplayRefill(void) {
+	TickType_t Now = xTaskGetTickCount();
+	u64_t Tokens = ReplayTokens + ((u64_t) (Now - ReplayTime) * portTICK_PERIOD_MS * ReplayBPS) / 1000;
+	u32_t Limit = (ReplayBPS > slSIZEBUF) ? ReplayBPS : slSIZEBUF;
+	ReplayTokens = (Tokens > Limit) ? Limit : Tokens;
+	ReplayTime = Now;
+}
+
+void vSyslogFileSend(void) {
+	// step 1: check if anything there to send & budget available
+	if (FileBuffer == 0)
+		return;
+	vSyslogReplayRefill();
+	if (ReplayTokens == 0)
+		return;
+	// step 2: check if scheduler running, LxSTA up and a failover group host connected
+	sl_host_t * psH = psSyslogActive();
+	if (psH == NULL)
+		return;
+	// step 3: protect the pass, lock order shSLnet -> shSLsock -> shSLfile -> shLFSmux
+	if (xRtosSemaphoreTake(&shSLsock, slMS_LOCK_WAIT) == pdFALSE)	/* semaphore taken? */
+		return;														/* no, return for now */
+	if (psH->state != slCON_UP)							// disconnected while waiting?
+		goto exit0;
+	if (xSyslogBatchFlush(psH) < erSUCCESS)				// live messages batched go first
+		goto exit0;
+	if (xRtosSemaphoreTake(&shSLfile, slMS_LOCK_WAIT) == pdFALSE)
+		goto exit0;
+	vSyslogStoreFlush();								// buffered records go after those in files
+	// step 4: try to lock file system for read [and delete/unlink]
+	if (xRtosSemaphoreTake(&shLFSmux, slMS_LOCK_WAIT) == pdFALSE)
+		goto exit1;
+
+	// step 5: replay records from the cursor onwards, within budget, cursor committed once batch sent
+	char * pBuf = malloc(slSIZEBUF + slSTORE_BUF);
+	u8_t * pRaw = (u8_t *) pBuf + slSIZEBUF;			// decompressed block at rdOfs
+	char caName[24];
+	bool bSave = 0;
+	int Count = 0, BlkSize = 0, RawLen = 0;				// BlkSize 0 = block not loaded
+	u32_t rdOfs = sCur.rdOfs, rdRec = sCur.rdRec;		// read position, ahead of cursor while batched
+	while (pBuf && Count < ReplayMsgs && (sCur.rdSeq != sCur.wrSeq || rdOfs < wrSize)) {
+		// step 5a: load & decompress the block at the read position if required
+		if (BlkSize == 0) {
+			vSyslogStoreName(caName, sCur.rdSeq);
+			BlkSize = xSyslogBlockLoad(caName, rdOfs, pRaw, &RawLen);
+		}
+		if (BlkSize < erSUCCESS) {						// read error, not end of segment
+			slSTAT_INC(StoreErrs);
+			break;										// keep segment, block re-read next pass
+		}
+		// step 5b: at end of (or invalid) segment, send batched records then discard it and move on
+		if (BlkSize == 0) {
+			if (xSyslogBatchFlush(psH) < erSUCCESS) {
+				rdOfs = sCur.rdOfs;						// batched records not sent, re-read next pass
+				rdRec = sCur.rdRec;
+				bSave = 1;
+				break;
+			}
+			vSyslogStoreUnlink(sCur.rdSeq);
+			if (sCur.rdSeq == sCur.wrSeq) {				// current write segment done?
+				++sCur.wrSeq;							// yes, store now empty
+				wrSize = 0;
+			}
+			++sCur.rdSeq;
+			sCur.rdOfs = rdOfs = sCur.rdRec = rdRec = 0;
+			bSave = 1;
+			continue;
+		}
+		// step 5c: at end of block move on to the next
+		if (rdRec >= RawLen) {
+			rdOfs += BlkSize;
+			rdRec = BlkSize = 0;
+			continue;
+		}
+		// step 5d: render the record, PRE header from binary fields & hostname bound now
+		sl_frec_t sRec;
+		int xPre, xLen = xSyslogRecRender(&pRaw[rdRec], RawLen - rdRec, &sRec, pBuf, &xPre);
+		if (xLen == 0) {
+			rdRec = RawLen;								// corrupt record, skip rest of block
+			continue;
+		}
+		// step 5e: stop if budget exhausted or urgent live message waiting, record will be re-read next pass
+		if (xLen > ReplayTokens)
+			break;
+		#if (slASYNC > 0)
+		if (__atomic_load_n(&sLane[0].head, __ATOMIC_RELAXED) != sLane[0].tail)
+			break;
+		#endif
+
+		// step 5f: batch the record, sending (and committing the cursor) first if batch full
+		if (bSyslogBatchFits(psH, xLen) == 0) {
+			if (xSyslogBatchFlush(psH) < erSUCCESS) {		// send failed, connection closed
+				rdOfs = sCur.rdOfs;
+				rdRec = sCur.rdRec;
+				bSave = 1;
+				break;									// abort, cursor at last record sent
+			}
+			sCur.rdOfs = rdOfs;
+			sCur.rdRec = rdRec;
+		}
+		xSyslogBatchAdd(psH, pBuf, xLen, xPre, xLen - xPre - sRec.len, 0, 1, sRec.pri, slFREC_UTC(&sRec));
+		rdRec += sizeof(sRec) + sRec.len;
+		ReplayTokens -= xLen;
+		++Count;
+		if (bSyslogBatchDue(psH, SL_SEV_DEBUG)) {
+			if (xSyslogBatchFlush(psH) < erSUCCESS) {
+				rdOfs = sCur.rdOfs;						// batched records not sent, re-read next pass
+				rdRec = sCur.rdRec;
+				bSave = 1;
+				break;
+			}
+			sCur.rdOfs = rdOfs;
+			sCur.rdRec = rdRec;
+		}
+	}
+	free(pBuf);
+	if (xSyslogBatchFlush(psH) == erSUCCESS) {				// remainder of pass sent?
+		sCur.rdOfs = rdOfs;								// yes, commit cursor
+		sCur.rdRec = rdRec;
+	}
+
+	// step 6: persist cursor (rate limited within a segment) so that replay resumes at the exact record
+	FileBuffer = (sCur.rdSeq != sCur.wrSeq || sCur.rdOfs < wrSize) ? 1 : 0;
+	if (bSave || FileBuffer == 0 || (xTaskGetTickCount() - CursorTime) >= pdMS_TO_TICKS(slMS_CURSOR_SAVE)) {
+		vSyslogStoreSaveCursor();
+		CursorTime = xTaskGetTickCount();
+	}
+	xRtosSemaphoreGive(&shLFSmux);
+exit1:
+	xRtosSemaphoreGive(&shSLfile);
+exit0:
+	xRtosSemaphoreGive(&shSLsock);
+}
+
+void vSyslogSetReplayBudget(u32_t BytesPerSec, int MsgsPerPass) {
+	ReplayBPS = BytesPerSec ? BytesPerSec : slREPLAY_BPS;
+	ReplayMsgs = (MsgsPerPass > 0) ? MsgsPerPass : slREPLAY_MSGS;
+}
+
+void vSyslogFileFlush(void) {
+	xRtosSemaphoreTake(&shSLfile, portMAX_DELAY);
+	vSyslogStoreFlush();
+	xRtosSemaphoreGive(&shSLfile);
+}
+
+void vSyslogFileCheckSize(void) {
+	unlink(slFILENAME);									// legacy text history, format not compatible
+	char caName[24];
+	FILE * fp = fopen(slCUR_NAME, "rb");
+	if (fp) {
+		if (fread(&sCur, sizeof(sCur), 1, fp) != 1 || sCur.magic != slCUR_MAGIC ||
+			(sCur.wrSeq - sCur.rdSeq) >= 0x80000000UL) {	// invalid or older format cursor?
+			memset(&sCur, 0, sizeof(sCur));				// yes, start afresh
+			for (int i = 0; i < slSEG_COUNT; ++i)		// segments could be in older format
+				vSyslogStoreUnlink(i);
+		}
+		fclose(fp);
+	}
+	sCur.magic = slCUR_MAGIC;
+	if ((sCur.wrSeq - sCur.rdSeq) >= slSEG_COUNT) {		// more segments than ring size?
+		sCur.rdSeq = sCur.wrSeq - (slSEG_COUNT - 1);	// yes, skip to oldest valid segment
+		sCur.rdOfs = sCur.rdRec = 0;
+	}
+	vSyslogStoreName(caName, sCur.wrSeq);
+	ssize_t Size = xFileSysGetFileSize(caName);
+	wrSize = (Size > 0) ? Size : 0;
+	FileBuffer = (sCur.rdSeq != sCur.wrSeq || sCur.rdOfs < wrSize) ? 1 : 0;
+}
+
+/**
+ * @brief	size of the block at Ofs from its header only
+ * @return	size of block in file, 0 if end of segment or invalid
+ */
+static int xSyslogBlockSize(const char * pcName, u32_t Ofs) {
+	FILE * fp = fopen(pcName, "rb");
+	if (fp == NULL)
+		return 0;
+	sl_fblk_t sBlk;
+	int Size = 0;
+	if (fseek(fp, Ofs, SEEK_SET) == 0 && fread(&sBlk, sizeof(sBlk), 1, fp) == 1 &&
+		sBlk.raw && sBlk.raw <= slSTORE_BUF && sBlk.packed < sBlk.raw)
+		Size = sizeof(sBlk) + (sBlk.packed ? sBlk.packed : sBlk.raw);
+	fclose(fp);
+	return Size;
+}
+
+/**
+ * @brief	load the index of a segment, rebuilt from its blocks if missing or not covering the segment
+ * @return	number of entries
+ * @note	caller must hold shSLfile & shLFSmux, pRaw of slSTORE_BUF only used if rebuilt
+ */
+static int xSyslogIndexLoad(u32_t Seq, sl_fidx_t * psI, u8_t * pRaw) {
+	char caName[24], caIdx[24];
+	vSyslogStoreName(caName, Seq);
+	vSyslogIndexName(caIdx, Seq);
+	ssize_t Size = xFileSysGetFileSize(caName);
+	if (Size <= 0)
+		return 0;
+	int Count = 0;
+	FILE * fp = fopen(caIdx, "rb");
+	if (fp) {
+		Count = fread(psI, sizeof(sl_fidx_t), slIDX_MAX, fp);
+		fclose(fp);
+	}
+	if (Count && (psI[Count - 1].ofs + xSyslogBlockSize(caName, psI[Count - 1].ofs)) == Size)
+		return Count;									// last entry's block ends the segment, valid
+	Count = 0;
+	for (u32_t Ofs = 0; Count < (int) slIDX_MAX && Ofs < Size; ) {
+		int RawLen, Blk = xSyslogBlockLoad(caName, Ofs, pRaw, &RawLen);
+		if (Blk < erSUCCESS)
+			return Count;								// read error, rebuilt again next time
+		if (Blk == 0)
+			break;
+		vSyslogIndexBuild(pRaw, RawLen, Ofs, &psI[Count++]);
+		Ofs += Blk;
+	}
+	if ((fp = fopen(caIdx, "wb")) != NULL) {
+		fwrite(psI, sizeof(sl_fidx_t), Count, fp);
+		fclose(fp);
+	}
+	return Count;
+}
+
+/**
+ * @brief	check from the index if block Idx could hold records matching the query
+ */
+static bool bSyslogQueryBlock(sl_query_t * psQ, sl_fidx_t * psI, int Idx, int Count) {
+	if ((psI[Idx].sev & ((2 << psQ->sev) - 1)) == 0)
+		return 0;										// no record of required severity
+	if (psQ->tTo && (psI[Idx].sec * 1000000ULL) > psQ->tTo)
+		return 0;										// starts after range
+	if ((Idx + 1) < Count && ((psI[Idx + 1].sec + 1) * 1000000ULL) <= psQ->tFrom)
+		return 0;										// next block starts before range
+	return 1;
+}
+
+/**
+ * @brief	match the records of a loaded block from byte First, reporting matches after the first Skip (if psR)
+ * @return	number of matching records, including those skipped
+ */
+static int xSyslogQueryRecs(report_t * psR, sl_query_t * psQ, const u8_t * pRaw, int RawLen, int First, char * pcBuf, int Skip) {
+	int Count = 0;
+	for (int i = First; (i + (int) sizeof(sl_frec_t)) <= RawLen; ) {
+		sl_frec_t sRec;
+		const u8_t * pRec = &pRaw[i];
+		memcpy(&sRec, pRec, sizeof(sRec));
+		i += sizeof(sRec) + sRec.len;
+		u64_t Utc = slFREC_UTC(&sRec);
+		if (i > RawLen || (sRec.pri & 7) > psQ->sev || Utc < psQ->tFrom || (psQ->tTo && Utc > psQ->tTo))
+			continue;
+		if (Count++ < Skip || psR == NULL)
+			continue;
+		int xPre, xLen = xSyslogRecRender(pRec, RawLen - (pRec - pRaw), &sRec, pcBuf, &xPre);
+		if (xLen)
+			xReport(psR, "%.*s" strNL, xLen, pcBuf);
+	}
+	return Count;
+}
+
+/**
+ * @brief	take store & file system locks, bounded wait
+ */
+static bool bSyslogQueryLock(void) {
+	if (xRtosSemaphoreTake(&shSLfile, slMS_LOCK_WAIT) == pdFALSE)
+		return 0;
+	if (xRtosSemaphoreTake(&shLFSmux, slMS_LOCK_WAIT) == pdFALSE) {
+		xRtosSemaphoreGive(&shSLfile);
+		return 0;
+	}
+	return 1;
+}
+
+static void vSyslogQueryUnlock(void) {
+	xRtosSemaphoreGive(&shLFSmux);
+	xRtosSemaphoreGive(&shSLfile);
+}
+
+/**
+ * @brief	load the index of segment Seq, locks held only while loading
+ * @return	number of entries, 0 if segment already replayed, erFAILURE if locks not taken
+ */
+static int xSyslogQueryIndex(u32_t Seq, sl_fidx_t * psI, u8_t * pRaw) {
+	if (bSyslogQueryLock() == 0)
+		return erFAILURE;
+	int Count = ((Seq - sCur.rdSeq) <= (sCur.wrSeq - sCur.rdSeq)) ? xSyslogIndexLoad(Seq, psI, pRaw) : 0;
+	vSyslogQueryUnlock();
+	return Count;
+}
+
+/**
+ * @brief	load block Idx of segment Seq if it could match & is not yet replayed, locks held only while loading
+ * @return	offset of first record not yet replayed, *pRawLen 0 if nothing to match, erFAILURE if locks not taken
+ */
+static int xSyslogQueryLoad(sl_query_t * psQ, u32_t Seq, sl_fidx_t * psI, int Idx, int Count, u8_t * pRaw, int * pRawLen) {
+	*pRawLen = 0;
+	if (bSyslogQueryBlock(psQ, psI, Idx, Count) == 0)
+		return 0;
+	if (bSyslogQueryLock() == 0)
+		return erFAILURE;
+	int First = 0;
+	if ((Seq - sCur.rdSeq) <= (sCur.wrSeq - sCur.rdSeq) && (Seq != sCur.rdSeq || psI[Idx].ofs >= sCur.rdOfs)) {
+		char caName[24];
+		vSyslogStoreName(caName, Seq);
+		if (xSyslogBlockLoad(caName, psI[Idx].ofs, pRaw, pRawLen) <= 0)
+			*pRawLen = 0;
+		else if (Seq == sCur.rdSeq && psI[Idx].ofs == sCur.rdOfs)
+			First = sCur.rdRec;							// block partly replayed
+	}
+	vSyslogQueryUnlock();
+	return First;
+}
+
+int xSyslogQuery(report_t * psR, sl_query_t * psQ) {
+	sl_fidx_t * psI = malloc(slIDX_MAX * sizeof(sl_fidx_t) + slSTORE_BUF + slSIZEBUF);
+	if (psI == NULL)
+		return erFAILURE;
+	u8_t * pRaw = (u8_t *) &psI[slIDX_MAX];
+	char * pcBuf = (char *) pRaw + slSTORE_BUF;
+	int iRV = erFAILURE;
+	if (xRtosSemaphoreTake(&shSLfile, slMS_LOCK_WAIT) == pdFALSE)
+		goto exit;
+	vSyslogStoreFlush();								// buffered records are the most recent, takes shLFSmux
+	u32_t rdSeq = sCur.rdSeq, wrSeq = sCur.wrSeq;		// segments at start, later ones not queried
+	xRtosSemaphoreGive(&shSLfile);
+
+	// step 1: tail-N, newest to oldest, find the block (and matches in it to skip) where output starts
+	u32_t Seq = rdSeq, Total = 0;
+	int Count, First, Blk = 0, Skip = 0, RawLen;
+	for (u32_t n = 0; psQ->last && n <= (wrSeq - rdSeq); ++n) {
+		u32_t S = wrSeq - n;
+		if ((Count = xSyslogQueryIndex(S, psI, pRaw)) < erSUCCESS)
+			goto exit;
+		for (int b = Count - 1; b >= 0; --b) {
+			if ((First = xSyslogQueryLoad(psQ, S, psI, b, Count, pRaw, &RawLen)) < erSUCCESS)
+				goto exit;
+			Total += RawLen ? xSyslogQueryRecs(NULL, psQ, pRaw, RawLen, First, pcBuf, 0) : 0;
+			if (Total >= psQ->last) {
+				Seq = S;
+				Blk = b;
+				Skip = Total - psQ->last;
+				goto found;
+			}
+		}
+	}
+found:
+	// step 2: oldest to newest from the start block, only reading blocks the index shows could match,
+	// locks released before each block's matches are reported so logging is never held up by the output
+	iRV = 0;
+	for (; (Seq - rdSeq) <= (wrSeq - rdSeq); ++Seq, Blk = 0) {
+		if ((Count = xSyslogQueryIndex(Seq, psI, pRaw)) < erSUCCESS)
+			goto fail;
+		for (int b = Blk; b < Count; ++b) {
+			if ((First = xSyslogQueryLoad(psQ, Seq, psI, b, Count, pRaw, &RawLen)) < erSUCCESS)
+				goto fail;
+			if (RawLen == 0)
+				continue;
+			int Match = xSyslogQueryRecs(psR, psQ, pRaw, RawLen, First, pcBuf, Skip);
+			iRV += (Match > Skip) ? Match - Skip : 0;
+			Skip = 0;
+		}
+	}
+	goto exit;
+fail:
+	iRV = erFAILURE;									// incomplete, store locks not available
+exit:
+	free(psI);
+	return iRV;
+}
+
+/**
+ * @brief	value following Key in a command string
+ */
+static u64_t xSyslogQueryArg(const char * pcCmd, const char * pcKey, u64_t Default) {
+	const char * pc = strstr(pcCmd, pcKey);
+	return pc ? strtoull(pc + strlen(pcKey), NULL, 10) : Default;
+}
+
+int xSyslogQueryCmd(report_t * psR, const char * pcCmd) {
+	pcCmd = pcCmd ? pcCmd : "";
+	u64_t Sev = xSyslogQueryArg(pcCmd, "sev=", SL_SEV_DEBUG), Last = xSyslogQueryArg(pcCmd, "last=", 0);
+	sl_query_t sQ = { .tFrom = xSyslogQueryArg(pcCmd, "from=", 0) * 1000000ULL,
+		.tTo = xSyslogQueryArg(pcCmd, "to=", 0) * 1000000ULL, .sev = (Sev > SL_SEV_DEBUG) ? SL_SEV_DEBUG : Sev,
+		.last = (Last > 0xFFFF) ? 0xFFFF : Last };
+	int iRV = xSyslogQuery(psR, &sQ);
+	if (iRV >= erSUCCESS)
+		xReport(psR, "SLOG\t%d records" strNL, iRV);
+	return iRV;
+}
+#endif
+
+/**
+ * @brief	console & host levels for a message, module override if any
+ * @return	console level, *pHost set to host level
+ */
+static int IRAM_ATTR xSyslogLevels(const char * FuncID, int * pHost) {
+	u32_t Levels = __atomic_load_n(&SLlevels, __ATOMIC_RELAXED);
+	int ConLevel = slLEV_CON(Levels);
+	*pHost = slLEV_HOST(Levels);
+	if (ModuleCount && FuncID) {
+		int Level = xSyslogModuleLevel(FuncID);
+		if (Level >= 0)
+			ConLevel = *pHost = Level;
+	}
+	return ConLevel;
+}
+
+/**
+ * @brief	without syslog task, do housekeeping & replay any offline backlog in the caller
+ */
+static void IRAM_ATTR vSyslogCallerTick(void) {
+	#if (slASYNC > 0)
+	if (__atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE))	// syslog task does this in background
+		return;
+	#endif
+	vSyslogTick();
+	#if (slTRACE > 0)
+	vSyslogTraceService();								// eg records retained through reset
+	#endif
+	#if (appLITTLEFS == 1)
+	vSyslogFileSend();									// single budgeted pass, not whole store
+	#endif
+}
+
+/**
+ * @brief	fill message variables, handling state of scheduler and obtaining the task name
+ */
+static void IRAM_ATTR vSyslogVars(sl_vars_t * psV, int MsgPRI, const char * FuncID, int HostLevel) {
+	psV->pri = MsgPRI & 0xFF;
+	psV->func = (FuncID == NULL) ? "null" : (*FuncID == 0) ? "empty" : FuncID;
+	psV->count = 0;
+	psV->sd = 0;
+	psV->core = esp_cpu_get_core_id();
+	psV->hlev = HostLevel;
+	psV->run = halTIMER_ReadRunTime();
+	psV->utc = sTSZ.usecs;
+	psV->task = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? DRAM_STR("preX") : pcTaskGetName(NULL);
+	slSTAT_INC(Logged[MsgPRI & 7]);
+}
+
+/**
+ * @brief	suppress if recent repeat (lock free), summarising any evicted entry with repeats
+ * @return	1 if repeat, to be discarded
+ */
+static bool IRAM_ATTR bSyslogRepeat(sl_vars_t * psV) {
+	sl_dedup_t sPrv;
+	bool bRepeat = bSyslogDedup(psV, &sPrv);
+	if (sPrv.sV.count)									// evicted/saturated entry with repeats?
+		vSyslogRepeated(&sPrv);							// yes, summarise before it is lost
+	return bRepeat;
+}
+
+void IRAM_ATTR xvSyslog(int MsgPRI, const char *FuncID, const char *format, va_list vaList) {
+	// step 0: check if message priority outside console threshold, module override if any
+	int HostLevel, ConLevel = xSyslogLevels(FuncID, &HostLevel);
+	sl_args_t sArgs;
+	int Capture = erFAILURE - 1;						// capture not yet attempted
+	bool bSent = 0;
+	#if (slTRACE > 0)
+	u32_t TraceSeq = 0;
+	if ((MsgPRI & 7) <= TraceLevel) {					// record, even if below console level
+		Capture = xSyslogCapture(&sArgs, format, vaList);
+		TraceSeq = xSyslogTraceRecord(MsgPRI, FuncID, format, (Capture == erSUCCESS) ? &sArgs : NULL);
+		if ((MsgPRI & 7) <= SL_SEV_ERROR && TraceLevel > HostLevel)
+			vSyslogTraceRequest(slTRACE_NEW);			// send context leading up to the error
+	}
+	#endif
+	if ((MsgPRI & 7) > ConLevel) {
+		slSTAT_INC(Filtered);
+		return;
+	}
+
+	// step 1: without syslog task, do housekeeping & replay any offline backlog here
+	vSyslogCallerTick();
+
+	// step 2: handle state of scheduler and obtain the task name
+	sl_vars_t sMsg;
+	vSyslogVars(&sMsg, MsgPRI, FuncID, HostLevel);
+	char * pcBuf = NULL, * pcBody = NULL;
+	int xLen = 0;
+	if (bSyslogRateCheck(&sMsg) == 0)					// rate limited, discard before rendering
+		goto exit;
+
+	// step 3: signature from call site & captured raw arguments, only render (and hash) if not capturable
+	u32_t Site = xSyslogHashVars(&sMsg, format, slPRI_LINE(MsgPRI));
+	if (Capture < erFAILURE)							// not captured for flight recorder?
+		Capture = xSyslogCapture(&sArgs, format, vaList);
+	if (Capture == erSUCCESS) {
+		sMsg.crc = xSyslogSignature(Site, &sArgs);
+	} else {
+		pcBuf = pcSyslogScratchClaim();
+		if (pcBuf == NULL) {							// all scratch buffers in use, never wait
+			slSTAT_INC(ScratchDrops);
+			goto exit;
+		}
+		pcBody = pcBuf + slHEADROOM;
+		xLen = xvSyslogBody(pcBody, slBODYSIZE, format, vaList);
+		sMsg.crc = xSyslogHash(Site, pcBody, xLen);
+	}
+
+	// step 4: suppress if recent repeat (lock free), repeats of captured messages are never rendered
+	if (bSyslogRepeat(&sMsg))
+		goto exit;
+	#if (slDEFERRED > 0)
+	bool bDefer = (Capture == erSUCCESS) && __atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE);
+	#else
+	bool bDefer = 0;
+	#endif
+	if (pcBuf == NULL && bDefer == 0) {					// captured but must be rendered here
+		pcBuf = pcSyslogScratchClaim();
+		if (pcBuf == NULL) {
+			slSTAT_INC(ScratchDrops);
+			goto exit;
+		}
+		pcBody = pcBuf + slHEADROOM;
+		xLen = xvSyslogBody(pcBody, slBODYSIZE, format, vaList);
+	}
+
+	// step 5: if syslog task running, post message for async delivery
+	#if (slASYNC > 0)
+	if (__atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE)) {
+		#if (slDEFERRED > 0)
+		if (bDefer)
+			bSent = (xSyslogPostArgs(&sMsg, format, &sArgs) == erSUCCESS);	// post captured message
+		else
+		#endif
+		bSent = (xSyslogPostBody(&sMsg, pcBody, xLen) == erSUCCESS);		// post rendered message
+		goto exit;
+	}
+	#endif
+
+	// step 6: deliver to console & host directly
+	vSyslogDeliver(&sMsg, pcBody, xLen);				// send current message
+	bSent = 1;
+exit:
+	#if (slTRACE > 0)
+	if (bSent && (MsgPRI & 7) <= HostLevel)				// only now known to have reached host
+		vSyslogTraceSent(TraceSeq);
+	#else
+	(void) bSent;
+	#endif
+	if (pcBuf)
+		vSyslogScratchFree(pcBuf);
+	vSyslogHist(sStats.CallerHist, halTIMER_ReadRunTime() - sMsg.run);
+}
+
+void IRAM_ATTR vSyslogKV(int MsgPRI, const char * FuncID, const char * SdID, const sl_kv_t * psKV, int Count) {
+	// step 0: check if message priority outside console threshold, module override if any
+	int HostLevel, ConLevel = xSyslogLevels(FuncID, &HostLevel);
+	bool bSent = 0;
+	#if (slTRACE > 0)
+	u32_t TraceSeq = 0;
+	if ((MsgPRI & 7) <= TraceLevel)						// SD-ID only, pairs not recorded
+		TraceSeq = xSyslogTraceRecord(MsgPRI, FuncID, SdID, NULL);
+	#endif
+	if ((MsgPRI & 7) > ConLevel || SdID == NULL) {
+		slSTAT_INC(Filtered);
+		return;
+	}
+
+	// step 1: without syslog task, do housekeeping & replay any offline backlog here
+	vSyslogCallerTick();
+
+	// step 2: message variables, body starts with SD-ELEMENT
+	sl_vars_t sMsg;
+	vSyslogVars(&sMsg, MsgPRI, FuncID, HostLevel);
+	sMsg.sd = 1;
+	char * pcBuf = NULL;
+	if (bSyslogRateCheck(&sMsg) == 0)
+		goto exit;
+
+	// step 3: encode pairs in binary form, signature from call site & encoded pairs
+	u8_t caKV[slRING_BODY];
+	int xKV = xSyslogKVEncode(caKV, sizeof(caKV), psKV, Count);
+	sMsg.crc = xSyslogHash(xSyslogHashVars(&sMsg, SdID, slPRI_LINE(MsgPRI)), caKV, xKV);
+
+	// step 4: suppress if recent repeat
+	if (bSyslogRepeat(&sMsg))
+		goto exit;
+
+	// step 5: if syslog task running, post pairs in binary form, rendered by the task
+	#if (slASYNC > 0)
+	if (__atomic_load_n(&hSLtask, __ATOMIC_ACQUIRE)) {
+		bSent = (xSyslogPostKV(&sMsg, SdID, caKV, xKV) == erSUCCESS);
+		goto exit;
+	}
+	#endif
+
+	// step 6: render & deliver to console & host directly
+	pcBuf = pcSyslogScratchClaim();
+	if (pcBuf == NULL) {
+		slSTAT_INC(ScratchDrops);
+		goto exit;
 	}
+	int xLen = xSyslogKVRender(pcBuf + slHEADROOM, slBODYSIZE, SdID, caKV, xKV);
+	vSyslogDeliver(&sMsg, pcBuf + slHEADROOM, xLen);
+	bSent = 1;
+exit:
+	#if (slTRACE > 0)
+	if (bSent && (MsgPRI & 7) <= HostLevel)
+		vSyslogTraceSent(TraceSeq);
+	#else
+	(void) bSent;
+	#endif
+	if (pcBuf)
+		vSyslogScratchFree(pcBuf);
+	vSyslogHist(sStats.CallerHist, halTIMER_ReadRunTime() - sMsg.run);
 }
 
 void IRAM_ATTR vSyslog(int MsgPRI, const char *FuncID, const char *format, ...) {
@@ -388,45 +3480,221 @@ int IRAM_ATTR xSyslogError(const char *FuncID, int iRV) {
 	return (iRV > 0) ? -iRV : iRV;
 }
 
+static void vSyslogReportHist(report_t * psR, const char * pcName, u32_t * pHist) {
+	xReport(psR, "\t%s uS", pcName);
+	for (int i = 0; i < slHIST_BINS; ++i) {
+		if (pHist[i])
+			xReport(psR, "  %lu+=%lu", (i == 0) ? 0UL : (1UL << (i - 1)), pHist[i]);
+	}
+	xReport(psR, strNL);
+}
+
 void vSyslogReport(report_t * psR) {
-	if (sCtx.sd <= 0)
-		return;
-	xNetReport(psR, &sCtx, "SLOG", 0, 0, 0);
-	xReport(psR, "\tmaxTX=%zu  CurRpt=%lu" strNL, sCtx.maxTx, sRpt.count);
+	static const char * const StateName[] = { "DOWN", "CONNECTING", "UP", "BACKOFF" };
+	static const char * const XportName[] = { "UDP", "TCP", "TLS" };
+	static const char * const RoleName[] = { "off", "failover", "copy" };
+	static const char * const SinkName[slSINK_NUM] = { "Console", "Host", "File", "Replay" };
+	sl_stats_t sS;
+	vSyslogGetStats(&sS);
+	xReport(psR, "SLOG\t%s  Reconnects=%lu  Failovers=%lu  Active=#%d" strNL, XportName[Transport], sS.Reconnects,
+		sS.Failovers, HostActive);
+	for (int i = 0; i < slHOSTS; ++i) {
+		sl_host_t * psH = &sHost[i];
+		if (psH->role == slROLE_OFF)
+			continue;
+		xReport(psR, "\t#%d %s %s  Addr=%s  Level=%d  Backoff=%lums  Batch=%d/%d  Sent=%lu  Fails=%lu  Drops=%lu" strNL,
+			i, RoleName[psH->role], StateName[psH->state & 3], psH->caAddr[0] ? psH->caAddr : "-",
+			(psH->level == slLEV_FOLLOW) ? -1 : psH->level, psH->backoff, psH->bcount, psH->blen, psH->sent,
+			psH->fails, psH->drops);
+		if (psH->sCtx.sd > 0) {
+			xNetReport(psR, &psH->sCtx, "SLOG", 0, 0, 0);
+			xReport(psR, "\tmaxTX=%zu" strNL, psH->sCtx.maxTx);
+		}
+	}
+	xReport(psR, "\tLogged=%lu/%lu/%lu/%lu/%lu/%lu/%lu/%lu  Filtered=%lu" strNL, sS.Logged[0], sS.Logged[1],
+		sS.Logged[2], sS.Logged[3], sS.Logged[4], sS.Logged[5], sS.Logged[6], sS.Logged[7], sS.Filtered);
+	xReport(psR, "\tDeduped=%lu  RateDrops=%lu  ScratchDrops=%lu  GovDrops=%lu  GovDemote=%d  GovTrips=%lu" strNL,
+		sS.Deduped, sS.RateDrops, sS.ScratchDrops, sS.GovDrops, GovDemote, sS.GovTrips);
+	xReport(psR, "\t");
+	for (int i = 0; i < slSINK_NUM; ++i)
+		xReport(psR, "%s=%lu/%luB  ", SinkName[i], sS.SinkMsgs[i], sS.SinkBytes[i]);
+	xReport(psR, "Sends=%lu  SendFails=%lu  StoreDepth=%lu  StoreEvict=%lu  StoreErrs=%lu" strNL, sS.Sends, sS.SendFails,
+		sS.StoreDepth, sS.StoreEvict, sS.StoreErrs);
+	#if (slCON_BUF > 0)
+	xReport(psR, "\tConsole buffer=%lu/%d  ConDrops=%lu" strNL, ConHead - ConTail, slCON_BUF, sS.ConDrops);
+	#endif
+	#if (slSTAGE_SIZE > 0)
+	xReport(psR, "\tStage=%s %d/%d  Staged=%lu  StageDrops=%lu" strNL, StageOpen ? "open" : "done", StageLen,
+		slSTAGE_SIZE, sS.Staged, sS.StageDrops);
+	#endif
+	#if (appLITTLEFS == 1)
+	if (sS.StoreRaw)
+		xReport(psR, "\tStore raw=%luB packed=%luB (%lu%%)" strNL, sS.StoreRaw, sS.StorePacked,
+			(sS.StorePacked * 100) / sS.StoreRaw);
+	#endif
+	vSyslogReportHist(psR, "Caller", sS.CallerHist);
+	vSyslogReportHist(psR, "Send", sS.SendHist);
+	for (int i = 0; i < slRATE_KEYS; ++i) {
+		if (sRatePri[i].drops)
+			xReport(psR, "\t  PRI=%d drops=%lu" strNL, (int) (uintptr_t) sRatePri[i].key, sRatePri[i].drops);
+		if (sRateFunc[i].drops)
+			xReport(psR, "\t  %s drops=%lu" strNL, (const char *) sRateFunc[i].key, sRateFunc[i].drops);
+	}
+	#if (slASYNC > 0)
+	xReport(psR, "\tRing=%lu/%d %lu/%d %lu/%d  Drops=%lu  Shed=%lu  Truncated=%lu  Policy=%d  Sched=%s" strNL,
+		sLane[0].head - sLane[0].tail, slLANE_HI, sLane[1].head - sLane[1].tail, slLANE_MID,
+		sLane[2].head - sLane[2].tail, slRING_SLOTS, sS.RingDrops, sS.LaneShed, sS.Truncated, RingPolicy,
+		(LaneSched == slSCHED_STRICT) ? "strict" : "weighted");
+	vSyslogReportHist(psR, "Urgent", sS.UrgentHist);
+	#endif
+	#if (slTRACE > 0)
+	xReport(psR, "\tTrace=%lu  Level=%d  Dumped=%lu" strNL, sTrace.head, TraceLevel, TraceDumped);
+	#endif
 }
 
 // #################################### Test and benchmark routines ################################
 
-#if 0
-#include "crc.h"
-
-void vSyslogBenchmark(void) {
-	char Test1[] = "SNTP vSntpTask ntp1.meraka.csir.co.za  2019-03-05T10:56:58.901Z  tOFF=78,873,521uS  tRTD=11,976uS" ;
-	char Test2[] = "01234567890ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz 01234567890ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz" ;
-
-	u32_t crc1, crc2, crc3, crc4, crc5, crc6 ;
-	vSysTimerReset(1 << stSLOG, stCLOCKS, "SLOG", myUS_TO_CLOCKS(10), myUS_TO_CLOCKS(1000)) ;
-	xSysTimerStart(stSLOG) ;
-	crc1 = F_CRC_CalculaCheckSum((u8_t *) Test1, sizeof(Test1)-1) ;
-	crc4 = F_CRC_CalculaCheckSum((u8_t *) Test2, sizeof(Test2)-1) ;
-	xSysTimerStop(stSLOG) ;
-	vSysTimerShow(1 << stSLOG) ;
-
-	vSysTimerReset(1 << stSLOG, stCLOCKS, "SLOG", myUS_TO_CLOCKS(10), myUS_TO_CLOCKS(1000)) ;
-	xSysTimerStart(stSLOG) ;
-	crc2 = crc32_le(0, (u8_t *) Test1, sizeof(Test1)-1) ;
-	crc5 = crc32_le(0, (u8_t *) Test2, sizeof(Test2)-1) ;
-	xSysTimerStop(stSLOG) ;
-	vSysTimerShow(1 << stSLOG) ;
-
-	vSysTimerReset(1 << stSLOG, stCLOCKS, "SLOG", myUS_TO_CLOCKS(10), myUS_TO_CLOCKS(1000)) ;
-	xSysTimerStart(stSLOG) ;
-	crc3 = crcSlow((u8_t *) Test1, sizeof(Test1)-1) ;
-	crc6 = crcSlow((u8_t *) Test2, sizeof(Test2)-1) ;
-	xSysTimerStop(stSLOG) ;
-	vSysTimerShow(1 << stSLOG) ;
-
-	printfx("CRC #1=%u  #2=%u  #3=%u" strNL, crc1, crc2, crc3) ;
-	printfx("CRC #4=%u  #5=%u  #6=%u" strNL, crc4, crc5, crc6) ;
+#if (slBENCHMARK > 0)
+enum { slBENCH_ACCEPT, slBENCH_FILTER, slBENCH_DEDUP, slBENCH_URGENT };
+
+typedef struct {
+	TaskHandle_t hOwner;
+	u8_t Phase;
+	u16_t Count;
+	u32_t Base;											// first message number, unique per producer
+	u32_t * pCycles;									// caller cost of each message, CPU cycles
+} sl_bench_t;
+
+static const char * const BenchName[] = { "Accepted", "Filtered", "Deduped", "Urgent" };
+static const char * const BenchFunc[] = { "slBenchA", "slBenchF", "slBenchD", "slBenchU" };
+
+static void vSyslogBenchTask(void * pvPara) {
+	sl_bench_t * psB = pvPara;
+	int Pri = (psB->Phase == slBENCH_FILTER) ? SL_SEV_DEBUG : SL_SEV_NOTICE;
+	for (int i = 0; i < psB->Count; ++i) {
+		u32_t Num = (psB->Phase == slBENCH_DEDUP) ? psB->Base : psB->Base + i;
+		if (psB->Phase == slBENCH_URGENT)				// DEBUG flood, every 16th an ERROR
+			Pri = (i & 15) ? SL_SEV_DEBUG : SL_SEV_ERROR;
+		u32_t tStart = esp_cpu_get_cycle_count();
+		vSyslog(Pri, BenchFunc[psB->Phase], "Bench #%lu value=%d.%03d", Num, i, i * 7);
+		psB->pCycles[i] = esp_cpu_get_cycle_count() - tStart;
+	}
+	xTaskNotifyGive(psB->hOwner);
+	vTaskDelete(NULL);
+}
+
+static int xSyslogBenchCompare(const void * pv1, const void * pv2) {
+	u32_t U1 = *(const u32_t *) pv1, U2 = *(const u32_t *) pv2;
+	return (U1 > U2) - (U1 < U2);
+}
+
+#define slCYCLES_TO_NS(x)	(((u64_t) (x) * 1000ULL) / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ)
+
+/**
+ * @brief	run one phase with Producers concurrent tasks, report caller cost distribution & throughput
+ */
+static void vSyslogBenchPhase(report_t * psR, int Phase, int Producers, int Count, u32_t * pCycles) {
+	sl_bench_t sB[slBENCH_TASKS];
+	sl_stats_t sS0, sS1;
+	vSyslogGetStats(&sS0);
+	u64_t tStart = halTIMER_ReadRunTime();
+	int Started = 0;
+	for (int i = 0; i < Producers; ++i) {
+		sB[i] = (sl_bench_t) { .hOwner = xTaskGetCurrentTaskHandle(), .Phase = Phase, .Count = Count,
+			.Base = i * Count, .pCycles = &pCycles[Started * Count] };
+		if (xTaskCreatePinnedToCore(vSyslogBenchTask, "slBench", slTASK_STACK, &sB[i], slTASK_PRIO,
+				NULL, i % portNUM_PROCESSORS) == pdPASS)
+			++Started;
+	}
+	for (int i = 0; i < Started; ++i)
+		ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+	u64_t tCall = halTIMER_ReadRunTime() - tStart;
+	#if (slASYNC > 0)
+	for (int i = 0; i < slMS_BENCH_DRAIN && xSyslogRingDepth(); ++i)
+		vTaskDelay(pdMS_TO_TICKS(1));					// wait for syslog task to deliver backlog
+	#endif
+	u64_t tDrain = halTIMER_ReadRunTime() - tStart;
+	vSyslogGetStats(&sS1);
+
+	int Total = Started * Count;
+	if (Total == 0)
+		return;
+	u64_t Sum = 0;
+	for (int i = 0; i < Total; ++i)
+		Sum += pCycles[i];
+	qsort(pCycles, Total, sizeof(u32_t), xSyslogBenchCompare);
+	xReport(psR, "%s\tx%d  avg=%lluns  p50=%lluns  p99=%lluns  p999=%lluns  max=%lluns  calls=%llu/s" strNL,
+		BenchName[Phase], Started, slCYCLES_TO_NS(Sum / Total), slCYCLES_TO_NS(pCycles[Total / 2]),
+		slCYCLES_TO_NS(pCycles[(Total * 99) / 100]), slCYCLES_TO_NS(pCycles[(Total * 999) / 1000]),
+		slCYCLES_TO_NS(pCycles[Total - 1]), (Total * 1000000ULL) / (tCall ? tCall : 1));
+	if (Phase == slBENCH_ACCEPT) {
+		u32_t Con = sS1.SinkMsgs[slSINK_CONSOLE] - sS0.SinkMsgs[slSINK_CONSOLE];
+		xReport(psR, "\tDelivered=%lu in %llums  %llu/s  Host=%lu  RingDrops=%lu  ScratchDrops=%lu" strNL, Con,
+			tDrain / 1000, (Con * 1000000ULL) / (tDrain ? tDrain : 1), sS1.SinkMsgs[slSINK_HOST] - sS0.SinkMsgs[slSINK_HOST],
+			sS1.RingDrops - sS0.RingDrops, sS1.ScratchDrops - sS0.ScratchDrops);
+	}
+	#if (slASYNC > 0)
+	if (Phase == slBENCH_URGENT) {						// ERROR delivery latency behind the DEBUG flood
+		for (int i = 0; i < slHIST_BINS; ++i)
+			sS1.UrgentHist[i] -= sS0.UrgentHist[i];
+		xReport(psR, "\tShed=%lu  RingDrops=%lu" strNL, sS1.LaneShed - sS0.LaneShed, sS1.RingDrops - sS0.RingDrops);
+		vSyslogReportHist(psR, "ERR delivered", sS1.UrgentHist);
+	}
+	#endif
+}
+
+#if (slHDR_CACHE > 0)
+/**
+ * @brief	caller cost of host & console header rendering, in full vs from the header cache
+ */
+static void vSyslogBenchHeader(report_t * psR, int Count) {
+	char caBuf[slHEADROOM];
+	sl_vars_t sV = { .pri = SL_SEV_NOTICE, .core = esp_cpu_get_core_id(), .task = pcTaskGetName(NULL),
+		.func = BenchFunc[slBENCH_ACCEPT] };
+	u64_t Sum[4] = { 0 };
+	int xPre, xName;
+	for (int i = 0; i < Count; ++i) {
+		sV.run = halTIMER_ReadRunTime();
+		sV.utc = sTSZ.usecs;
+		u32_t t0 = esp_cpu_get_cycle_count();
+		xSyslogHostHeaderFull(&sV, caBuf, &xPre, &xName);
+		u32_t t1 = esp_cpu_get_cycle_count();
+		xSyslogHostHeader(&sV, caBuf, &xPre, &xName);
+		u32_t t2 = esp_cpu_get_cycle_count();
+		xSyslogConHeaderFull(&sV, caBuf);
+		u32_t t3 = esp_cpu_get_cycle_count();
+		xSyslogConHeader(&sV, caBuf);
+		u32_t t4 = esp_cpu_get_cycle_count();
+		Sum[0] += t1 - t0;
+		Sum[1] += t2 - t1;
+		Sum[2] += t3 - t2;
+		Sum[3] += t4 - t3;
+	}
+	xReport(psR, "Header\thost full=%lluns cached=%lluns  console full=%lluns cached=%lluns" strNL,
+		slCYCLES_TO_NS(Sum[0] / Count), slCYCLES_TO_NS(Sum[1] / Count),
+		slCYCLES_TO_NS(Sum[2] / Count), slCYCLES_TO_NS(Sum[3] / Count));
+}
+#endif
+
+void vSyslogBenchmark(report_t * psR, int Producers, int Count) {
+	Producers = (Producers < 1) ? 1 : (Producers > slBENCH_TASKS) ? slBENCH_TASKS : Producers;
+	Count = (Count < 1) ? 1 : (Count > 0xFFFF) ? 0xFFFF : Count;
+	u32_t * pCycles = malloc(Producers * Count * sizeof(u32_t));
+	if (pCycles == NULL)
+		return;
+	u16_t SavePri = RatePri, SaveFunc = RateFunc;
+	RatePri = RateFunc = 0;								// measure the logging path, not the limiter
+	xSyslogSetModuleLevel(BenchFunc[slBENCH_FILTER], SL_SEV_ERROR);
+	xSyslogSetModuleLevel(BenchFunc[slBENCH_URGENT], SL_SEV_DEBUG);	// flood passes console & host level
+	for (int Phase = slBENCH_ACCEPT; Phase <= slBENCH_URGENT; ++Phase)
+		vSyslogBenchPhase(psR, Phase, Producers, Count, pCycles);
+	xSyslogSetModuleLevel(BenchFunc[slBENCH_FILTER], -1);
+	xSyslogSetModuleLevel(BenchFunc[slBENCH_URGENT], -1);
+	#if (slHDR_CACHE > 0)
+	vSyslogBenchHeader(psR, Count);
+	#endif
+	RatePri = SavePri;
+	RateFunc = SaveFunc;
+	free(pCycles);
 }
 #endif
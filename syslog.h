@@ -55,27 +55,199 @@ extern "C" {
 
 // '<7>1 2021/10/21T12:34.567: cc50e38819ec_WROVERv4_5C9 #0 esp_timer halVARS_Report????? - '
 #define slSIZEBUF					512
-#define slFILESIZE					10204				// MAX history (at boot) size before truncation
+#define slSCRATCH_COUNT				4					// scratch buffers shared by all callers, max 32
+#define slHEADROOM					128					// reserved ahead of body for console/host header
+#define slTAILROOM					16					// reserved after body for trailer/terminators
+#define slBODYSIZE					(slSIZEBUF - slHEADROOM - slTAILROOM)
+#define slFILESIZE					10204				// MAX offline history, spread over slSEG_COUNT segments
 
 // Specify default SYSLOG destination
 #define	slDEFAULT_HOST				"logs5.papertrailapp.com"
 #define	slDEFAULT_PORT				28535
-#define slFILENAME					"/syslog.txt"		// default file name in root directory
+#define slFILENAME					"/syslog.txt"		// legacy (text) file name, removed at startup
+
+// Offline store, ring of segment files with persisted read cursor
+#define slSEG_COUNT					4					// number of segment files in ring
+#define slSEG_SIZE					(slFILESIZE / slSEG_COUNT)
+#define slSEG_NAME					"/syslog%d.dat"		// segment file name, % slSEG_COUNT
+#define slCUR_NAME					"/syslog.cur"		// persisted read cursor
+#define slIDX_NAME					"/syslog%d.idx"		// sparse block index of segment, % slSEG_COUNT
+#define slSTORE_BUF					1024				// append buffer, flushed as 1 compressed block, MAX 1024
+#define slMS_STORE_FLUSH			1000				// max age of buffered records before flush
+
+// Boot staging, host messages held in RAM until first connection then sent, or written to store in bulk
+#define slSTAGE_SIZE				2048				// 0=disabled, MUST be <= slSEG_SIZE
+#define slMS_STAGE_HOLD				30000				// run time after which staged messages go to the store
 
 #define UNKNOWNMACAD				"#UnknownMAC#"		// MAC address marker in pre-wifi messages
 
 #define slMS_LOCK_WAIT				200					/* was 1000 */
-#define slMS_FILESEND_DLY			5
+
+// Host transport, stream transports use RFC6587 octet counting framing
+#define slXPORT_UDP					0
+#define slXPORT_TCP					1
+#define slXPORT_TLS					2					// RFC5425, requires security context
+#define slPORT_TCP					601					// default ports if not configured in HostInfo[]
+#define slPORT_TLS					6514
+
+// Host registry, entry 0 from options (HostInfo[]) others added by xSyslogSetHost(), 1 rendering for all
+#define slHOSTS						3					// entries, including entry 0
+#define slHOST_NAME					32					// max registered host name, incl terminator
+#define slROLE_OFF					0					// entry not used
+#define slROLE_FAILOVER				1					// group, first connected in entry order, offline store backed
+#define slROLE_COPY					2					// independent copy, own level, dropped while down
+
+// Batched writes, host messages coalesced and sent as a single write
+#define slBATCH_SIZE				1460				// MUST be >= slSIZEBUF + 8
+#define slBATCH_MSGS				32					// max messages per batch
+#define slMS_BATCH_FLUSH			50					// max age of batched message before flush
+#define slUDP_BATCH					0					// UDP datagram budget for LF separated messages, 0=1 per datagram
+
+// Host connection, exponential backoff between failed attempts & cached resolved address
+#define slMS_BACKOFF_MIN			1000
+#define slMS_BACKOFF_MAX			60000
+#define slRESOLVE_TTL				3600				// seconds before host name is resolved again
+#define slRESOLVE_RETRIES			3					// consecutive failures that force name resolution
+
+// Offline store replay budget, bounds bandwidth and lock hold time per pass
+#define slREPLAY_BPS				4096				// bytes per second
+#define slREPLAY_MSGS				8					// max records per pass
+#define slMS_REPLAY_TICK			20					// interval between passes while backlog exists
+#define slMS_CURSOR_SAVE			5000				// min interval between cursor saves within segment
+
+// Repeat suppression, table of recent message signatures
+#define slDEDUP_SIZE				8					// number of signatures tracked
+#define slMS_DEDUP_WINDOW			5000				// repeats summarised & idle entries freed after
+
+// Rate limiting, token buckets keyed by PRI and by FuncID (0 rate = unlimited)
+#define slRATE_KEYS					16					// buckets per key type, MUST be a power of 2
+#define slRATE_PRI					50					// messages/sec per PRI
+#define slRATE_PRI_BURST			20
+#define slRATE_FUNC					20					// messages/sec per FuncID
+#define slRATE_FUNC_BURST			10
+#define slRATE_EXEMPT				SL_SEV_ERROR		// severities <= this never rate limited
+
+// Host governor, temporarily lowers host level while sends fail or are slow
+#define slMS_GOV_WINDOW				1000				// evaluation window
+#define slMS_GOV_RESTORE			10000				// clean time required before each level restored
+#define slGOV_FAILS					3					// send failures per window to trip
+#define slGOV_LATENCY				20000				// average send latency (uS) per window to trip
+
+// Per module/function verbosity overrides, matched as prefix of FuncID
+#define slMODULE_MAX				8
+#define slMODULE_LEN				16
+
+// Runtime selectable header formats
+#define slFMT_PAPERTRAIL			0					// host: "<PRI>1 TIME HOST task/core func - - "
+#define slFMT_RFC5424				1					// host: "<PRI>1 TIME HOST task core func - "
+#define slFMT_CON_ANSI				0					// console: coloured "RUN core task func "
+#define slFMT_CON_PLAIN				1					// console: same as ANSI without colour
+#define slFMT_CON_COMPACT			2					// console: "S RUNms func " S = severity letter
+
+// Console sink, lines buffered & written by a low priority task so a slow UART never delays the host
+#define slCON_BUF					2048				// 0=caller writes unbuffered, MUST be a power of 2
+#define slCON_STACK					2048
+#define slCON_PRIO					1					// below slTASK_PRIO
+#define slMS_CON_WAIT				2					// max wait for buffer access, else line dropped
+
+// Header cache, timestamp per second & task fragments reused, hostname prebuilt once connected
+#define slHDR_CACHE					1					// 0=render headers in full for every message
+#define slHDR_TASKS					16					// task fragment slots, direct mapped
+
+// Asynchronous delivery, callers only post to a lock-free ring drained by the syslog task
+#define slASYNC						1					// 0=caller delivers, 1=syslog task delivers
+#define slRING_SLOTS				16					// INFO..DEBUG lane, MUST be a power of 2
+#define slLANE_HI					4					// EMERG..ERR lane, MUST be a power of 2
+#define slLANE_MID					8					// WARNING..NOTICE lane, MUST be a power of 2
+#define slLANE_SCHED				slSCHED_WEIGHTED	// default lane scheduling
+#define slLANE_W_HI					8					// weighted, messages per round from EMERG..ERR lane
+#define slLANE_W_MID				4					// weighted, from WARNING..NOTICE lane, INFO..DEBUG gets 1
+#define slRING_BODY					slBODYSIZE			// max rendered body or %s pool per slot, smaller saves RAM but truncates
+#define slTASK_STACK				3072
+#define slTASK_PRIO					2
+#define slMS_TASK_TICK				100
+#define slNET_STACK					4096				// connection task, name resolution & TLS handshake
+#define slNET_PRIO					1					// below slTASK_PRIO
+
+// Deferred formatting, callers capture format pointer & raw arguments, syslog task renders
+#define slDEFERRED					1					// 0=render at caller, 1=defer (requires slASYNC)
+#define slMAX_ARGS					8					// more arguments fall back to rendering at caller
+#define slMAX_SPEC					16					// longest single conversion specification
+
+// Flight recorder, captured (not rendered) messages kept in no-init RAM, survives a soft reset
+// Messages up to slTRACE_LEVEL pass the SL_LOG() gate even if below console/host levels, each costs
+// argument evaluation, capture & a record (no rendering), set 0 or lower the level to filter inline again
+#define slTRACE						1					// 0=excluded, 1=included (requires slDEFERRED)
+#define slTRACE_SLOTS				32					// records kept, MUST be a power of 2
+#define slTRACE_STR					32					// bytes of %s arguments copied per record
+#define slTRACE_LEVEL				SL_SEV_DEBUG		// default level recorded, independent of console/host levels
+
+// Ring overflow policies
+#define slOVF_DROP_NEW				0					// discard the message being posted
+#define slOVF_DROP_OLD				1					// evict the oldest queued message, else drop new if still being posted
+#define slOVF_BLOCK					2					// wait for a free slot (tasks only, not ISR/syslog task)
+
+// Lane scheduling, syslog task drains EMERG..ERR, WARNING..NOTICE & INFO..DEBUG lanes
+#define slSCHED_STRICT				0					// higher lane always first, lower lanes may starve
+#define slSCHED_WEIGHTED			1					// weighted round robin, lower lanes always progress
+
+// Statistics, relaxed atomic counters & log2 latency histograms
+#define slHIST_BINS					16					// bin 0 = 0uS, bin n = 2^(n-1)..2^n-1 uS, last bin open ended
+#define slMS_STATS_EMIT				0					// interval between RFC5424 SD statistics messages, 0=never
+#define slSTATS_SDID				"stats@32473"		// SD-ID of statistics message, PEN from RFC5612 (documentation)
+
+// Benchmark of caller cost (accepted/filtered/deduped) & delivery rate, see vSyslogBenchmark() & host/
+#ifdef ESP_PLATFORM
+	#define slBENCHMARK				0					// 0=excluded, 1=included
+#else
+	#define slBENCHMARK				1					// host (Linux) build, always included
+#endif
+#define slBENCH_TASKS				8					// max concurrent producer tasks
+#define slMS_BENCH_DRAIN			5000				// max wait for ring to drain after accepted phase
 
 // ############################## Syslog formatting/calling macros #################################
 
 #define SL_PRI(fac,sev)				(((fac)<<3) | ((sev)&7))
+
+// SLlevels snapshot, gate (max of console & module levels), console & host levels as nibbles
+#define slLEVELS(gate,con,host)		(((host)<<8) | ((con)<<4) | (gate))
+#define slLEV_GATE(x)				((x) & 0x0F)
+#define slLEV_CON(x)				(((x) >> 4) & 0x0F)
+#define slLEV_HOST(x)				(((x) >> 8) & 0x0F)
+
+// Call site line# carried in PRI bits [30:16], with FuncID & format pointer forms the call site ID
+#define slPRI_SITE(pri)				((pri) | ((__LINE__ & 0x7FFF) << 16))
+#define slPRI_LINE(x)				(((x) >> 16) & 0x7FFF)
+
+// Arguments are only evaluated if the severity passes both compile time and cached runtime levels
 #define SL_LOG(pri, f, ...) 		do { 												\
-										if (((pri)&7) <= SL_LEV_MAX) {					\
-											 vSyslog(pri,__FUNCTION__,f,##__VA_ARGS__);	\
+										if (((pri)&7) <= SL_LEV_MAX &&					\
+											((pri)&7) <= slLEV_GATE(__atomic_load_n(&SLlevels, __ATOMIC_RELAXED))) { \
+											 vSyslog(slPRI_SITE(pri),__FUNCTION__,f,##__VA_ARGS__);	\
 										} 												\
 									} while(0)
 
+// Typed key/value pairs as 1 SD-ELEMENT, eg SL_KV(SL_SEV_INFO, "env@32473", slKV("temp", T), slKV("id", pcID))
+// SD-ID & PARAM-NAMEs must be static strings (pointers are kept), string values are copied
+// Values of other types, eg pointers other than strings, fail to compile rather than being misreported
+#define slKV(k, v)					_Generic((v),																		\
+									float: sSyslogKVdbl, double: sSyslogKVdbl,											\
+									char *: sSyslogKVstr, const char *: sSyslogKVstr,									\
+									_Bool: sSyslogKVbool,																\
+									char: sSyslogKVi32, signed char: sSyslogKVi32, short: sSyslogKVi32,					\
+									int: sSyslogKVi32, long: sSyslogKVi32,												\
+									unsigned char: sSyslogKVu32, unsigned short: sSyslogKVu32,							\
+									unsigned int: sSyslogKVu32, unsigned long: sSyslogKVu32,							\
+									long long: sSyslogKVi64, unsigned long long: sSyslogKVu64)(k, v)
+
+#define SL_KV(pri, sdid, ...)		do {																							\
+										if (((pri)&7) <= SL_LEV_MAX &&																\
+											((pri)&7) <= slLEV_GATE(__atomic_load_n(&SLlevels, __ATOMIC_RELAXED))) {				\
+											const sl_kv_t _sKV[] = { __VA_ARGS__ };													\
+											vSyslogKV(slPRI_SITE(pri), __FUNCTION__, sdid, _sKV, sizeof(_sKV) / sizeof(sl_kv_t));	\
+										}																							\
+									} while(0)
+
 #define SL_ERROR(err) 				xSyslogError(__FUNCTION__, err)
 #define	SL_EMER(fmt, ...)			SL_LOG(SL_SEV_EMERGENCY, fmt, ##__VA_ARGS__)
 #define	SL_ALRT(fmt, ...)			SL_LOG(SL_SEV_ALERT, fmt, ##__VA_ARGS__)
@@ -96,9 +268,58 @@ extern "C" {
 #define	IF_SL_INFO(tst, fmt, ...)	if (tst) SL_INFO(fmt, ##__VA_ARGS__)
 #define	IF_SL_DBG(tst, fmt, ...)	if (tst) SL_DBG(fmt, ##__VA_ARGS__)
 
+// ###################################### Structures ###############################################
+
+enum { slSINK_CONSOLE, slSINK_HOST, slSINK_FILE, slSINK_REPLAY, slSINK_NUM };
+
+enum { slKV_I32, slKV_U32, slKV_I64, slKV_U64, slKV_DBL, slKV_BOOL, slKV_STR };
+
+typedef struct {
+	const char * key;									// PARAM-NAME
+	u8_t type;											// slKV_xxx
+	union {
+		i32_t i32;
+		u32_t u32;
+		i64_t i64;
+		u64_t u64;
+		double f64;
+		const char * str;
+	};
+} sl_kv_t;
+
+static inline sl_kv_t sSyslogKVi32(const char * k, i32_t v) { return (sl_kv_t) { .key = k, .type = slKV_I32, .i32 = v }; }
+static inline sl_kv_t sSyslogKVu32(const char * k, u32_t v) { return (sl_kv_t) { .key = k, .type = slKV_U32, .u32 = v }; }
+static inline sl_kv_t sSyslogKVi64(const char * k, i64_t v) { return (sl_kv_t) { .key = k, .type = slKV_I64, .i64 = v }; }
+static inline sl_kv_t sSyslogKVu64(const char * k, u64_t v) { return (sl_kv_t) { .key = k, .type = slKV_U64, .u64 = v }; }
+static inline sl_kv_t sSyslogKVdbl(const char * k, double v) { return (sl_kv_t) { .key = k, .type = slKV_DBL, .f64 = v }; }
+static inline sl_kv_t sSyslogKVbool(const char * k, _Bool v) { return (sl_kv_t) { .key = k, .type = slKV_BOOL, .u32 = v }; }
+static inline sl_kv_t sSyslogKVstr(const char * k, const char * v) { return (sl_kv_t) { .key = k, .type = slKV_STR, .str = v }; }
+
+// all members u32_t, snapshot is taken one (relaxed atomic) word at a time
+typedef struct {
+	u32_t Logged[8];									// per severity, passed console/module level
+	u32_t Filtered;										// rejected by module level in xvSyslog(), not SL_LOG() gate
+	u32_t RateDrops, Deduped, ScratchDrops, RingDrops, GovDrops;
+	u32_t LaneShed;										// lower severity evicted for higher, also in RingDrops
+	u32_t ConDrops;										// console buffer full (or busy), line not written
+	u32_t Truncated;									// posted body or %s string cut to fit slRING_BODY, ends with "..."
+	u32_t SinkMsgs[slSINK_NUM], SinkBytes[slSINK_NUM];	// per slSINK_xxx
+	u32_t Sends, SendFails, Reconnects, GovTrips, StoreEvict;	// Sends = datagrams/stream writes
+	u32_t StoreErrs;									// offline store block not written (kept), partly (cut back) or not read (retried)
+	u32_t Failovers;									// failover group changed host, incl back to preferred
+	u32_t Staged, StageDrops;							// boot staging, held in RAM & discarded when full
+	u32_t StoreDepth;									// approximate bytes awaiting replay, set by snapshot
+	u32_t StoreRaw, StorePacked;						// offline store block bytes before/after compression
+	u32_t CallerHist[slHIST_BINS];						// uS from timestamp to return from xvSyslog()
+	u32_t SendHist[slHIST_BINS];						// uS per xNetSend() to host
+	u32_t UrgentHist[slHIST_BINS];						// uS from timestamp to delivered, EMERG..ERR via syslog task
+} sl_stats_t;
+
 // ###################################### Global variables #########################################
 
-extern SemaphoreHandle_t shSLsock, shSLvars;			// public to enable semaphore un/lock tracking
+extern SemaphoreHandle_t shSLsock, shSLvars, shSLfile, shSLnet;	// public to enable semaphore un/lock tracking
+																// shSLvars retained for tracking, no longer taken
+extern u32_t SLlevels;									// cached level snapshot, see slLEVELS()
 
 // ###################################### function prototypes ######################################
 
@@ -126,10 +347,156 @@ void vSyslogSetConsoleLevel(int Level);
 void vSyslogSetHostLevel(int Level);
 
 /**
- * @brief	Check size of slFILENAME, if bigger than slFILESIZE will unlink/delete the file to make space
+ * @brief	set verbosity level for all functions whose name starts with pcName
+ * @param[in]	pcName module or function name prefix eg "xNet" or "vSntpTask"
+ * @param[in]	Level new console & host level for matching functions, <0 to remove override
+ * @return	erSUCCESS or erFAILURE if table full or invalid parameter
+ */
+int xSyslogSetModuleLevel(const char * pcName, int Level);
+
+/**
+ * @brief	parse and apply a module level override for use by the options CLI
+ * @param[in]	pcCmd string formatted as "name=level", "name=-1" to remove
+ * @return	erSUCCESS or erFAILURE if malformed or table full
+ */
+int xSyslogConfigModule(const char * pcCmd);
+
+/**
+ * @brief	set the token bucket rates used to limit messages
+ * @param[in]	PerPri messages/sec per PRI, 0 to disable
+ * @param[in]	PerFunc messages/sec per FuncID, 0 to disable
+ */
+void vSyslogSetRateLimit(int PerPri, int PerFunc);
+
+/**
+ * @brief	select the host transport, closes the current connection if any
+ * @param[in]	Transport slXPORT_UDP, slXPORT_TCP or slXPORT_TLS
+ * @param[in]	pvSec (sec_t *) security context passed to socketsX, required for slXPORT_TLS
+ * @return	erSUCCESS or erFAILURE if invalid parameter or connection busy
+ * @note	streams are batched by the syslog task, flushed by size, age or severity <= SL_SEV_ERROR
+ */
+int xSyslogSetTransport(int Transport, void * pvSec);
+
+/**
+ * @brief	enable/disable packing multiple LF separated messages per UDP datagram
+ * @param[in]	Size datagram budget in bytes (max slBATCH_SIZE), 0 to send 1 message per datagram
+ * @note	collector must accept LF separated messages, a single larger message is always sent alone
+ */
+void vSyslogSetUdpBatch(int Size);
+
+/**
+ * @brief	add, change or remove a host registry entry, the same rendered message goes to all hosts
+ * @param[in]	Idx entry 1..slHOSTS-1, entry 0 is the failover host configured via options
+ * @param[in]	pcName host name or dotted decimal address, copied
+ * @param[in]	Port 0 for the transport default
+ * @param[in]	Role slROLE_OFF, slROLE_FAILOVER or slROLE_COPY
+ * @param[in]	Level max severity sent to this host, -1 to follow the host level (& governor)
+ * @return	erSUCCESS or erFAILURE
+ * @note	messages above the console level (or module override) never reach any host
+ */
+int xSyslogSetHost(int Idx, const char * pcName, int Port, int Role, int Level);
+
+/**
+ * @brief	select the header format prepended to host/console messages
+ * @param[in]	Format slFMT_PAPERTRAIL/slFMT_RFC5424 (host) or slFMT_CON_ANSI/PLAIN/COMPACT (console)
+ */
+void vSyslogSetHostFormat(int Format);
+void vSyslogSetConsoleFormat(int Format);
+
+/**
+ * @brief	initialise the message ring and start the syslog task (if slASYNC enabled)
+ * @note	messages logged before this call, or if the task fails to start, are delivered synchronously
+ */
+void vSyslogInit(void);
+
+/**
+ * @brief	select the policy applied when the message ring is full
+ * @param[in]	Policy one of slOVF_DROP_NEW, slOVF_DROP_OLD or slOVF_BLOCK
+ */
+void vSyslogSetOverflow(int Policy);
+
+/**
+ * @brief	select how the syslog task schedules the severity lanes
+ * @param[in]	Sched slSCHED_STRICT or slSCHED_WEIGHTED
+ * @note	a full lane spills into lower severity lanes, evicting their oldest messages first
+ */
+void vSyslogSetLaneSched(int Sched);
+
+/**
+ * @brief	return the number of messages discarded due to ring overflow
+ */
+u32_t xSyslogGetDropped(void);
+
+/**
+ * @brief	take a snapshot of the statistics counters
+ * @param[out]	psStats structure to be filled
+ * @note	each counter is consistent, the set of counters is not
+ */
+void vSyslogGetStats(sl_stats_t * psStats);
+
+/**
+ * @brief	set the level of messages recorded by the flight recorder
+ * @param[in]	Level messages with severity <= Level are recorded, even if below console/host levels
+ * @note	recorded messages must pass the SL_LOG() gate, Level above console level disables inline
+ * 			filtering of those messages, they are captured & recorded (never rendered unless dumped)
+ */
+void vSyslogSetTraceLevel(int Level);
+
+/**
+ * @brief	render the flight recorder contents to the host (or offline store if host not available)
+ * @note	done by the syslog task if running. Dumps of records not sent to the host are triggered
+ * 			automatically by messages of SL_SEV_ERROR and higher, and after a soft reset (incl panic)
+ */
+void vSyslogTraceDump(void);
+
+/**
+ * @brief	Load the offline store cursor, evict segments beyond slSEG_COUNT and remove legacy slFILENAME
 */
 void vSyslogFileCheckSize(void);
 
+/**
+ * @brief	Replay a single budgeted pass of the offline store to the host
+ * @note	called by the syslog task, or at the start of each log call if the task is not running
+*/
+void vSyslogFileSend(void);
+
+/**
+ * @brief	set the offline store replay budget
+ * @param[in]	BytesPerSec maximum average replay bandwidth
+ * @param[in]	MsgsPerPass maximum records sent per pass, bounds shSLsock & shLFSmux hold times
+*/
+void vSyslogSetReplayBudget(u32_t BytesPerSec, int MsgsPerPass);
+
+/**
+ * @brief	Write any buffered offline records to the current segment file
+*/
+void vSyslogFileFlush(void);
+
+typedef struct {
+	u64_t tFrom, tTo;									// UTC uS, inclusive, 0 = unbounded
+	u8_t sev;											// records with severity <= sev
+	u16_t last;											// 0 = all matching records, else only the last N
+} sl_query_t;
+
+/**
+ * @brief	report offline store records matching a query, oldest first
+ * @param[in]	psR pointer to report structure
+ * @param[in]	psQ time range, severity & tail-N limits
+ * @return	number of records reported, erFAILURE if store busy or no memory
+ * @note	only blocks the sparse index shows could match are read & decompressed,
+ * 			covers records not yet replayed, buffered records are flushed first,
+ * 			store locks are held per block loaded, never while reporting
+*/
+int xSyslogQuery(report_t * psR, sl_query_t * psQ);
+
+/**
+ * @brief	report offline store records as per command
+ * @param[in]	psR pointer to report structure
+ * @param[in]	pcCmd string formatted as "[last=N] [sev=X] [from=T1] [to=T2]", T in UTC seconds
+ * @return	number of records reported, erFAILURE if store busy or no memory
+*/
+int xSyslogQueryCmd(report_t * psR, const char * pcCmd);
+
 /**
  * @brief		writes an RFC formatted message to stdout & syslog host (if up and running)
  * @param[in]	MsgPRI PRIority (combined FACility & SEVerity)
@@ -139,6 +506,15 @@ void vSyslogFileCheckSize(void);
 */
 void xvSyslog(int MsgPRI, const char * FuncID, const char * format, va_list args);
 
+/**
+ * @brief		log typed key/value pairs as a single escaped RFC5424 SD-ELEMENT, no format string parsed
+ * @param[in]	SdID SD-ID eg "name@PEN", static string
+ * @param[in]	psKV array of Count pairs, normally built by SL_KV() & slKV()
+ * @note		pairs are carried in binary form through the async ring & only rendered when delivered,
+ * 				pairs that do not fit slRING_BODY (or the body) are dropped whole
+*/
+void vSyslogKV(int MsgPRI, const char * FuncID, const char * SdID, const sl_kv_t * psKV, int Count);
+
 /**
  * @brief		writes an RFC formatted message to stdout & syslog host (if up and running)
  * @param[in]	MsgPRI PRIority (combined FACility & SEVerity)
@@ -166,6 +542,19 @@ int xSyslogError(const char * FuncID, int eCode);
 */
 void vSyslogReport(report_t * psR);
 
+#if (slBENCHMARK > 0)
+/**
+ * @brief	measure caller cost & delivery rate using concurrent producer tasks
+ * @param[in]	psR pointer to report structure
+ * @param[in]	Producers number of concurrent tasks (1..slBENCH_TASKS), pinned round robin to cores
+ * @param[in]	Count number of messages each task logs per phase
+ * @note	reports avg/p50/p99/p999/max ns per accepted, filtered & deduped message and messages/s
+ * 			delivered by the syslog task, then ERROR delivery latency behind a DEBUG flood.
+ * 			Rate limiting is suspended for the duration.
+ */
+void vSyslogBenchmark(report_t * psR, int Producers, int Count);
+#endif
+
 #ifdef __cplusplus
 }
 #endif